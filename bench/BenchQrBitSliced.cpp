@@ -0,0 +1,101 @@
+/*
+Throughput of exhaustive mask selection for a batch of symbols of one
+version, one symbol at a time with QrMaskSelector against 64 symbols at
+once with QrBitSlicedBatch. The symbols are placement tables of the
+given version filled with seeded random codewords, as a batch of serial
+number labels would produce.
+
+It reports symbols per second for both paths and the speedup of the
+bit-sliced one, and fails if the two disagree on any mask or penalty.
+
+Usage: BenchQrBitSliced [--symbols N] [--version N] [--seed N]
+*/
+
+#include "utils/QrBenchUtils.hpp"
+#include "../include/QrBitSlicedBatch.hpp"
+#include "../include/QrCodewordPlacement.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    size_t symbolCount = 4096;
+    int version = 2;
+    unsigned int seed = 27;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--symbols") {
+            symbolCount = std::stoul(value);
+        } else if (name == "--version") {
+            version = std::stoi(value);
+        } else if (name == "--seed") {
+            seed = static_cast<unsigned int>(std::stoul(value));
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Option " << argv[argc - 1] << " needs a value" << std::endl;
+        return 1;
+    }
+
+    std::vector<QrModuleMatrix> symbols;
+    const QrPlacementTable* table;
+    try {
+        table = &QrCodewordPlacement::getTable(version);
+        std::mt19937 eng(seed);
+        std::vector<uint8_t> codewords(table->positions.size() / 8);
+        symbols.reserve(symbolCount);
+        for (size_t i = 0; i < symbolCount; ++i) {
+            for (uint8_t& codeword : codewords) {
+                codeword = static_cast<uint8_t>(eng());
+            }
+            QrModuleMatrix matrix = table->reserved;
+            QrCodewordPlacement::placeCodewords(codewords, *table, matrix);
+            symbols.push_back(matrix);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    QrEncodeOptions options;
+    options.maskStrategy = QrMaskStrategy::Exhaustive;
+    std::vector<QrMaskSelection> scalar;
+    scalar.reserve(symbols.size());
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const QrModuleMatrix& symbol : symbols) {
+        scalar.push_back(QrMaskSelector::selectMask(symbol, table->reserved, options));
+    }
+    double scalarSeconds = getSecondsSince(start);
+
+    std::vector<QrMaskSelection> sliced;
+    sliced.reserve(symbols.size());
+    start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < symbols.size(); first += QrBitSlicedBatch::LaneCount) {
+        size_t last = std::min(first + QrBitSlicedBatch::LaneCount, symbols.size());
+        std::vector<QrModuleMatrix> group(symbols.begin() + first, symbols.begin() + last);
+        std::vector<QrMaskSelection> selections = QrBitSlicedBatch::selectMasks(group, table->reserved);
+        sliced.insert(sliced.end(), selections.begin(), selections.end());
+    }
+    double slicedSeconds = getSecondsSince(start);
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (scalar[i].mask != sliced[i].mask || scalar[i].penalty != sliced[i].penalty) {
+            std::cerr << "Symbol " << i << ": mask " << sliced[i].mask << " penalty " << sliced[i].penalty
+                      << " instead of mask " << scalar[i].mask << " penalty " << scalar[i].penalty << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << symbols.size() << " symbols, version " << version << std::endl;
+    std::cout << std::setw(12) << "path" << std::setw(12) << "symbols/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(0)
+              << std::setw(12) << "scalar" << std::setw(12) << symbols.size() / scalarSeconds << std::endl;
+    std::cout << std::setw(12) << "bit-sliced" << std::setw(12) << symbols.size() / slicedSeconds << std::endl;
+    std::cout << std::setprecision(2) << "speedup " << scalarSeconds / slicedSeconds << std::endl;
+    return 0;
+}
@@ -0,0 +1,100 @@
+/*
+Throughput of classifying a string column of catalog identifiers. The
+rows are seeded random SKUs and IDs of 8 to 40 bytes, numeric,
+alphanumeric or lower case, stored in one Arrow style buffer.
+
+It reports rows per second and per minute for every kernel level this
+CPU supports, with the given thread budget, against calling
+QrModeSelector and QrVersionSelector once per row, and fails if any
+path disagrees with the per-row selectors.
+
+Usage: BenchQrBulkClassifier [--rows N] [--threads N] [--seed N]
+*/
+
+#include "utils/QrBenchUtils.hpp"
+#include "../include/QrBulkClassifier.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+int main(int argc, char** argv) {
+    size_t rowCount = 4000000;
+    int threadCount = 1;
+    unsigned int seed = 34;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--rows") {
+            rowCount = std::stoul(value);
+        } else if (name == "--threads") {
+            threadCount = std::stoi(value);
+        } else if (name == "--seed") {
+            seed = static_cast<unsigned int>(std::stoul(value));
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Option " << argv[argc - 1] << " needs a value" << std::endl;
+        return 1;
+    }
+
+    static const std::string alphabets[] = {"0123456789", "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-./",
+                                            "abcdefghijklmnopqrstuvwxyz0123456789-_"};
+    std::mt19937 eng(seed);
+    std::uniform_int_distribution<size_t> length(8, 40);
+    std::vector<int32_t> offsets(1, 0);
+    std::vector<char> bytes;
+    for (size_t row = 0; row < rowCount; ++row) {
+        const std::string& alphabet = alphabets[eng() % 3];
+        for (size_t i = length(eng); i > 0; --i) {
+            bytes.push_back(alphabet[eng() % alphabet.size()]);
+        }
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+    }
+    const QrErrorCorrectionLevel level = QrErrorCorrectionLevel::MEDIUM;
+
+    std::vector<QrBulkClassification> expected(rowCount);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t row = 0; row < rowCount; ++row) {
+        std::string text(bytes.data() + offsets[row], offsets[row + 1] - offsets[row]);
+        expected[row].mode = QrModeSelector::getQrMode(text);
+        expected[row].version = QrVersionSelector::getQrVersion(static_cast<int>(text.length()), level, expected[row].mode);
+    }
+    double perRowSeconds = getSecondsSince(start);
+
+    std::cout << rowCount << " rows, " << bytes.size() << " bytes, " << threadCount << " threads" << std::endl;
+    std::cout << std::setw(12) << "path" << std::setw(14) << "rows/s" << std::setw(14) << "rows/min" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::fixed << std::setprecision(0)
+              << std::setw(12) << "per-row" << std::setw(14) << rowCount / perRowSeconds << std::setw(14) << 60 * rowCount / perRowSeconds
+              << std::setw(10) << "1.0" << std::endl;
+
+    QrBulkTuning original = QrBulkClassifier::getTuning();
+    QrBulkTuning tuning = original;
+    tuning.parallelThreshold = 0;
+    std::vector<QrBulkClassification> results(rowCount);
+    for (int kernelLevel = 0; kernelLevel <= static_cast<int>(QrCpuDispatch::detectLevel()); ++kernelLevel) {
+        tuning.kernelLevel = static_cast<QrCpuLevel>(kernelLevel);
+        QrBulkClassifier::setTuning(tuning);
+        double seconds = std::numeric_limits<double>::max();
+        for (int run = 0; run < 3; ++run) {
+            start = std::chrono::steady_clock::now();
+            QrBulkClassifier::classify(offsets.data(), bytes.data(), rowCount, level, results.data(), threadCount);
+            seconds = std::min(seconds, getSecondsSince(start));
+        }
+        for (size_t row = 0; row < rowCount; ++row) {
+            if (results[row].mode != expected[row].mode || results[row].version != expected[row].version) {
+                std::cerr << QrCpuDispatch::getLevelName(tuning.kernelLevel) << " kernel disagrees on row " << row << std::endl;
+                return 1;
+            }
+        }
+        std::cout << std::setprecision(0) << std::setw(12) << QrCpuDispatch::getLevelName(tuning.kernelLevel)
+                  << std::setw(14) << rowCount / seconds << std::setw(14) << 60 * rowCount / seconds
+                  << std::setprecision(1) << std::setw(10) << perRowSeconds / seconds << std::endl;
+    }
+    QrBulkClassifier::setTuning(original);
+    return 0;
+}
@@ -0,0 +1,155 @@
+/*
+Throughput of writing one PBM image per symbol with every available
+QrFileBatchWriter backend. Each backend writes the same symbols into its
+own directory; the report shows files per second and megabytes per
+second, so the batched backends can be compared against the plain POSIX
+path.
+
+The symbols are placement tables of the versions picked for a seeded
+payload mix with the payload bytes placed and masked, as in the
+scalability benchmark; only the file output is timed.
+
+The directory and its parents are created if needed.
+
+Usage: BenchQrFileOutput <directory> [--files N] [--threads N] [--batch-kib N]
+                         [--queue-depth N] [--dots N] [--seed N]
+*/
+
+#include "utils/QrBenchUtils.hpp"
+#include "../include/QrCodewordPlacement.hpp"
+#include "../include/QrFileBatchWriter.hpp"
+#include "../include/QrMaskSelector.hpp"
+#include "../include/QrModeSelector.hpp"
+#include "../include/QrRowRenderer.hpp"
+#include "../include/QrVersionSelector.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+
+/**
+ * Creates a directory and its missing parents, like mkdir -p.
+ *
+ * @return An empty string on success; the reason otherwise.
+ */
+std::string createDirectories(const std::string& path) {
+    for (size_t end = path.find('/', 1);; end = path.find('/', end + 1)) {
+        std::string prefix = path.substr(0, end);
+        if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return "Cannot create directory \"" + prefix + "\": " + std::strerror(errno);
+        }
+        if (end == std::string::npos) {
+            break;
+        }
+    }
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+        return "\"" + path + "\" is not a directory";
+    }
+    return "";
+}
+
+/**
+ * Builds the masked symbol of a payload.
+ */
+QrModuleMatrix createSymbol(const std::string& payload, const QrEncodeOptions& options) {
+    QrMode mode = QrModeSelector::getQrMode(payload);
+    int version = QrVersionSelector::getQrVersion(payload, options.level, mode);
+    const QrPlacementTable& table = QrCodewordPlacement::getTable(version);
+
+    std::vector<uint8_t> codewords(table.positions.size() / 8);
+    for (size_t i = 0; i < codewords.size(); ++i) {
+        codewords[i] = i < payload.length() ? static_cast<uint8_t>(payload[i]) : ((i - payload.length()) % 2 == 0 ? 0xEC : 0x11);
+    }
+
+    QrModuleMatrix matrix = table.reserved;
+    QrCodewordPlacement::placeCodewords(codewords, table, matrix);
+    QrMaskSelection selection = QrMaskSelector::selectMask(matrix, table.reserved, options);
+    QrMaskSelector::applyMask(matrix, table.reserved, selection.mask);
+    return matrix;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc % 2 != 0) {
+        std::cerr << "Usage: BenchQrFileOutput <directory> [--files N] [--threads N] [--batch-kib N] "
+                     "[--queue-depth N] [--dots N] [--seed N]" << std::endl;
+        return 1;
+    }
+    std::string directory = argv[1];
+    size_t fileCount = 20000;
+    unsigned int seed = 40;
+    int dotsPerModule = 4;
+    QrFileBatchOptions batchOptions;
+
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--files") {
+            fileCount = std::stoul(value);
+        } else if (name == "--threads") {
+            batchOptions.threadCount = std::stoi(value);
+        } else if (name == "--batch-kib") {
+            batchOptions.batchBytes = std::stoul(value) << 10;
+        } else if (name == "--queue-depth") {
+            batchOptions.queueDepth = static_cast<unsigned int>(std::stoul(value));
+        } else if (name == "--dots") {
+            dotsPerModule = std::stoi(value);
+        } else if (name == "--seed") {
+            seed = static_cast<unsigned int>(std::stoul(value));
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+
+    // Short identifiers, the common case for one file per symbol
+    std::vector<std::string> payloads = generatePayloadMix("ids", fileCount, seed);
+    QrEncodeOptions options;
+    std::vector<QrModuleMatrix> symbols;
+    symbols.reserve(payloads.size());
+    for (const std::string& payload : payloads) {
+        symbols.push_back(createSymbol(payload, options));
+    }
+
+    std::cout << payloads.size() << " files, " << dotsPerModule << " dots per module, "
+              << (batchOptions.batchBytes >> 10) << " KiB batches" << std::endl;
+    std::cout << std::setw(12) << "backend" << std::setw(12) << "files/s" << std::setw(10) << "MB/s" << std::endl;
+
+    const QrFileBackend backends[] = {QrFileBackend::Posix, QrFileBackend::ThreadPool, QrFileBackend::IoUring};
+    const char* const names[] = {"posix", "threadpool", "io_uring"};
+    for (int b = 0; b < 3; ++b) {
+        if (!QrFileBatchWriter::isAvailable(backends[b])) {
+            std::cout << std::setw(12) << names[b] << "  not built (liburing 2.2 or newer not found at configure time)" << std::endl;
+            continue;
+        }
+        std::string backendDirectory = directory + "/" + names[b];
+        std::string error = createDirectories(backendDirectory);
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+
+        uint64_t bytes = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try {
+            std::unique_ptr<QrFileBatchWriter> writer = QrFileBatchWriter::create(backends[b], batchOptions);
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                int size = (symbols[i].size() + 8) * dotsPerModule;
+                bytes += static_cast<uint64_t>((size + 7) / 8) * size;
+                writer->writePbm(backendDirectory + "/" + std::to_string(i) + ".pbm", symbols[i], dotsPerModule, 4);
+            }
+            writer->flush();
+        } catch (const std::exception& e) {
+            std::cerr << names[b] << ": " << e.what() << std::endl;
+            return 1;
+        }
+        double seconds = getSecondsSince(start);
+
+        std::cout << std::fixed << std::setprecision(0)
+                  << std::setw(12) << names[b] << std::setw(12) << symbols.size() / seconds
+                  << std::setprecision(1) << std::setw(10) << bytes / seconds / 1e6 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+Throughput of fountain coded frame sequences. A seeded random payload is
+encoded into frames for the given symbol version, a share of the frames
+is dropped and the rest is shuffled, as a camera would read them, and
+fed to a decoder until the payload is complete.
+
+It reports frames per second and payload bytes per second for encoding
+(with the given thread budget) and decoding, and the number of frames
+the decoder needed relative to the block count.
+
+Usage: BenchQrFountain [--payload-kib N] [--version N] [--loss PERCENT]
+                       [--threads N] [--seed N]
+*/
+
+#include "utils/QrBenchUtils.hpp"
+#include "../include/QrFountainCodec.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char** argv) {
+    size_t payloadLength = 256 << 10;
+    int version = 20;
+    double loss = 20;
+    unsigned int seed = 36;
+    QrEncodeOptions options;
+    options.level = QrErrorCorrectionLevel::LOW;
+    options.threadBudget = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--payload-kib") {
+            payloadLength = std::stoul(value) << 10;
+        } else if (name == "--version") {
+            version = std::stoi(value);
+        } else if (name == "--loss") {
+            loss = std::stod(value);
+        } else if (name == "--threads") {
+            options.threadBudget = std::stoi(value);
+        } else if (name == "--seed") {
+            seed = static_cast<unsigned int>(std::stoul(value));
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Option " << argv[argc - 1] << " needs a value" << std::endl;
+        return 1;
+    }
+
+    std::mt19937 eng(seed);
+    std::string payload(payloadLength, '\0');
+    for (char& c : payload) {
+        c = static_cast<char>(eng());
+    }
+
+    size_t blockSize;
+    size_t blockCount;
+    std::vector<QrFountainFrame> frames;
+    double encodeSeconds;
+    try {
+        blockSize = QrFountainEncoder::getBlockSize(version, options.level);
+        blockCount = QrFountainEncoder::getBlockCount(payload.length(), blockSize);
+        // Enough frames to survive the loss with a margin for the decoding overhead
+        size_t frameCount = static_cast<size_t>(blockCount / (1 - std::min(loss, 90.0) / 100) * 2) + 32;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        frames = QrFountainEncoder::encodeFrames(payload, blockSize, 0, frameCount, options);
+        encodeSeconds = getSecondsSince(start);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::bernoulli_distribution dropped(std::min(loss, 90.0) / 100);
+    std::vector<const QrFountainFrame*> received;
+    for (const QrFountainFrame& frame : frames) {
+        if (!dropped(eng)) {
+            received.push_back(&frame);
+        }
+    }
+    std::shuffle(received.begin(), received.end(), eng);
+
+    QrFountainDecoder decoder;
+    size_t framesUsed = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const QrFountainFrame* frame : received) {
+        decoder.addFrame(frame->text);
+        ++framesUsed;
+        if (decoder.isComplete()) {
+            break;
+        }
+    }
+    bool complete = decoder.isComplete() && decoder.getPayload() == payload;
+    double decodeSeconds = getSecondsSince(start);
+
+    std::cout << payload.length() << " bytes, version " << version << ", " << blockSize << " byte blocks, "
+              << blockCount << " blocks, " << loss << "% loss, " << options.threadBudget << " threads" << std::endl;
+    std::cout << std::setw(8) << "" << std::setw(12) << "frames" << std::setw(12) << "frames/s" << std::setw(10) << "MB/s" << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << std::setw(8) << "encode" << std::setw(12) << frames.size() << std::setw(12) << frames.size() / encodeSeconds
+              << std::setw(10) << payload.length() / encodeSeconds / 1e6 << std::endl;
+    std::cout << std::setw(8) << "decode" << std::setw(12) << framesUsed << std::setw(12) << framesUsed / decodeSeconds
+              << std::setw(10) << payload.length() / decodeSeconds / 1e6 << std::endl;
+    if (!complete) {
+        std::cerr << "Decoding did not recover the payload; send more frames" << std::endl;
+        return 1;
+    }
+    std::cout << std::setprecision(3) << "overhead " << static_cast<double>(framesUsed) / blockCount << " frames per block" << std::endl;
+    return 0;
+}
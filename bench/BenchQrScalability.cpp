@@ -0,0 +1,138 @@
+/*
+Scalability benchmark of the whole symbol pipeline: mode selection,
+version selection, codeword placement, mask selection and row rendering.
+The same seeded payload mix is processed with 1, 2, 4, ... threads up to
+the maximum, every thread taking the next symbol from a shared counter.
+
+For every thread count it reports symbols per second, the speedup over
+one thread, the p50 and p99 latency of a symbol, heap allocations per
+symbol, and the number of failed claims of the shared counter. Speedup
+falling behind the thread count while allocations stay flat points at
+false sharing or shared tables; growing claim retries point at the
+counter itself.
+
+The tree has no data or error correction encoder yet, so the codewords
+are the payload bytes followed by the standard pad bytes.
+
+The header shows the number of cores. Thread counts above it share cores,
+so their speedup and latency measure the scheduler rather than the
+pipeline; the benchmark warns when --max-threads exceeds the core count.
+
+Usage: BenchQrScalability [--symbols N] [--max-threads N] [--mix ids|text|mixed]
+                          [--seed N] [--mask exhaustive|fast|fixed] [--dots N]
+*/
+
+#include "utils/QrPipelineWorker.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+int main(int argc, char** argv) {
+    size_t symbolCount = 5000;
+    // hardware_concurrency may return 0 when the core count is unknown
+    unsigned int cores = std::thread::hardware_concurrency();
+    int maxThreads = static_cast<int>(std::max(1u, cores));
+    std::string mix = "mixed";
+    unsigned int seed = 39;
+    int dotsPerModule = 4;
+    QrEncodeOptions options;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        std::string value = argv[i + 1];
+        if (name == "--symbols") {
+            symbolCount = std::stoul(value);
+        } else if (name == "--max-threads") {
+            maxThreads = std::max(1, std::stoi(value));
+        } else if (name == "--mix") {
+            mix = value;
+        } else if (name == "--seed") {
+            seed = static_cast<unsigned int>(std::stoul(value));
+        } else if (name == "--dots") {
+            dotsPerModule = std::stoi(value);
+        } else if (name == "--mask") {
+            options.maskStrategy = value == "fast" ? QrMaskStrategy::Fast
+                                 : value == "fixed" ? QrMaskStrategy::Fixed : QrMaskStrategy::Exhaustive;
+        } else {
+            std::cerr << "Unknown option " << name << std::endl;
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Option " << argv[argc - 1] << " needs a value" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> payloads = generatePayloadMix(mix, symbolCount, seed);
+    std::cout << "mix " << mix << ", " << payloads.size() << " symbols, seed " << seed
+              << ", up to " << maxThreads << " threads, "
+              << (cores > 0 ? std::to_string(cores) : "unknown") << " cores" << std::endl;
+    if (cores > 0 && static_cast<unsigned int>(maxThreads) > cores) {
+        std::cerr << "warning: --max-threads " << maxThreads << " exceeds the core count (" << cores
+                  << "); rows with more threads than cores are oversubscribed" << std::endl;
+    }
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "symbols/s" << std::setw(9) << "speedup"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(14) << "allocs/symbol"
+              << std::setw(15) << "claim retries" << std::endl;
+
+    // Build the shared placement tables before timing, so every run sees the same state
+    for (int version = 1; version <= 40; ++version) {
+        QrCodewordPlacement::getTable(version);
+    }
+
+    std::vector<int> threadCounts;
+    for (int threadCount = 1; threadCount < maxThreads; threadCount *= 2) {
+        threadCounts.push_back(threadCount);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baseline = 0;
+    uint64_t expectedChecksum = 0;
+    for (int threadCount : threadCounts) {
+        std::atomic<size_t> nextIndex(0);
+        std::vector<WorkerStats> stats(threadCount);
+        std::vector<std::thread> threads;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int t = 1; t < threadCount; ++t) {
+            threads.push_back(std::thread(runWorker, std::cref(payloads), std::cref(options), dotsPerModule,
+                                          std::ref(nextIndex), std::ref(stats[t])));
+        }
+        runWorker(payloads, options, dotsPerModule, nextIndex, stats[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double seconds = getSecondsSince(start);
+
+        std::vector<double> latencies;
+        uint64_t allocations = 0;
+        uint64_t claimRetries = 0;
+        uint64_t checksum = 0;
+        for (const WorkerStats& worker : stats) {
+            latencies.insert(latencies.end(), worker.latencies.begin(), worker.latencies.end());
+            allocations += worker.allocations;
+            claimRetries += worker.claimRetries;
+            checksum += worker.checksum;
+        }
+        if (threadCount == 1) {
+            expectedChecksum = checksum;
+        } else if (checksum != expectedChecksum) {
+            std::cerr << "Output differs from the single thread run" << std::endl;
+            return 1;
+        }
+
+        double throughput = payloads.size() / seconds;
+        if (threadCount == 1) {
+            baseline = throughput;
+        }
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << threadCount << std::setw(12) << throughput
+                  << std::setprecision(2) << std::setw(9) << throughput / baseline
+                  << std::setprecision(1) << std::setw(10) << getPercentile(latencies, 50)
+                  << std::setw(10) << getPercentile(latencies, 99)
+                  << std::setprecision(2) << std::setw(14) << static_cast<double>(allocations) / payloads.size()
+                  << std::setw(15) << claimRetries << std::endl;
+    }
+    return 0;
+}
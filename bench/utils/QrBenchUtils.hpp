@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Number of heap allocations made by the current thread, counted by the replaced operator new.
+ * Each thread counts its own allocations, so the counter itself causes no contention.
+ */
+thread_local uint64_t threadAllocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++threadAllocationCount;
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+/**
+ * Generates a seeded mix of payloads.
+ *
+ * @param mix "ids" (short numeric and alphanumeric codes), "text" (UTF-8 text and URLs) or "mixed" (both,
+ *            plus a few long payloads which select large versions).
+ * @param count Number of payloads.
+ * @param seed Seed of the generator, so runs can be repeated.
+ * @return The payloads.
+ */
+std::vector<std::string> generatePayloadMix(const std::string& mix, size_t count, unsigned int seed) {
+    static const std::string digits = "0123456789";
+    static const std::string alphanumeric = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+    static const std::string text = "abcdefghijklmnopqrstuvwxyz0123456789-_/.?=&";
+    static const char* const multiByte[] = {u8"ą", u8"ę", u8"ł", u8"ó", u8"ß", u8"é", u8"€"};
+
+    std::mt19937 eng(seed);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::vector<std::string> payloads;
+    payloads.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        int k = kind(eng);
+        bool idPayload = mix == "ids" || (mix == "mixed" && k < 5);
+        std::string payload;
+        if (idPayload) {
+            const std::string& alphabet = k % 2 == 0 ? digits : alphanumeric;
+            size_t length = std::uniform_int_distribution<size_t>(8, 24)(eng);
+            for (size_t j = 0; j < length; ++j) {
+                payload += alphabet[eng() % alphabet.size()];
+            }
+        } else {
+            bool longPayload = mix == "mixed" && k == 9;
+            size_t length = longPayload ? std::uniform_int_distribution<size_t>(800, 1800)(eng)
+                                        : std::uniform_int_distribution<size_t>(30, 160)(eng);
+            payload = "https://example.com/";
+            while (payload.length() < length) {
+                if (eng() % 16 == 0) {
+                    payload += multiByte[eng() % 7];
+                } else {
+                    payload += text[eng() % text.size()];
+                }
+            }
+        }
+        payloads.push_back(payload);
+    }
+    return payloads;
+}
+
+/**
+ * Returns the value at the given percentile (0-100) of the samples, sorting them.
+ */
+double getPercentile(std::vector<double>& samples, double percentile) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = static_cast<size_t>(percentile / 100.0 * (samples.size() - 1) + 0.5);
+    return samples[std::min(index, samples.size() - 1)];
+}
+
+/**
+ * Returns the seconds elapsed since the given time point.
+ */
+double getSecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "QrBenchUtils.hpp"
+#include "../../include/QrCodewordPlacement.hpp"
+#include "../../include/QrMaskSelector.hpp"
+#include "../../include/QrModeSelector.hpp"
+#include "../../include/QrRowRenderer.hpp"
+#include "../../include/QrVersionSelector.hpp"
+
+/**
+ * Counters of one thread, kept on the thread's own stack while it runs.
+ */
+struct WorkerStats {
+    std::vector<double> latencies;      ///< Latency of every symbol in microseconds.
+    uint64_t allocations = 0;           ///< Heap allocations made while processing symbols.
+    uint64_t claimRetries = 0;          ///< Failed attempts to claim the next symbol.
+    uint64_t checksum = 0;              ///< Sum over the rendered rows, keeps the work observable.
+};
+
+/**
+ * Runs one payload through the pipeline: mode and version selection, codeword placement, mask selection
+ * and row rendering. The tree has no data or error correction encoder yet, so the codewords are the payload
+ * bytes followed by the standard pad bytes.
+ *
+ * @return A checksum of the rendered rows.
+ */
+uint64_t processSymbol(const std::string& payload, const QrEncodeOptions& options, int dotsPerModule) {
+    QrMode mode = QrModeSelector::getQrMode(payload);
+    int version = QrVersionSelector::getQrVersion(payload, options.level, mode);
+    const QrPlacementTable& table = QrCodewordPlacement::getTable(version);
+
+    std::vector<uint8_t> codewords(table.positions.size() / 8);
+    for (size_t i = 0; i < codewords.size(); ++i) {
+        codewords[i] = i < payload.length() ? static_cast<uint8_t>(payload[i]) : ((i - payload.length()) % 2 == 0 ? 0xEC : 0x11);
+    }
+
+    QrModuleMatrix matrix = table.reserved;
+    QrCodewordPlacement::placeCodewords(codewords, table, matrix);
+    QrMaskSelection selection = QrMaskSelector::selectMask(matrix, table.reserved, options);
+    QrMaskSelector::applyMask(matrix, table.reserved, selection.mask);
+
+    uint64_t checksum = 0;
+    QrRowRenderer renderer(matrix, dotsPerModule, 4);
+    while (const unsigned char* row = renderer.nextRow()) {
+        checksum += row[renderer.bytesPerRow() / 2];
+    }
+    return checksum;
+}
+
+/**
+ * Processes symbols claimed from the shared counter until none are left.
+ * A claim only counts as retried when another thread took the symbol first, so one thread never retries.
+ */
+void runWorker(const std::vector<std::string>& payloads, const QrEncodeOptions& options, int dotsPerModule,
+               std::atomic<size_t>& nextIndex, WorkerStats& result) {
+    WorkerStats stats;
+    stats.latencies.reserve(payloads.size());
+    uint64_t allocationsBefore = threadAllocationCount;
+
+    while (true) {
+        size_t index = nextIndex.load(std::memory_order_relaxed);
+        while (index < payloads.size() && !nextIndex.compare_exchange_strong(index, index + 1)) {
+            ++stats.claimRetries;
+        }
+        if (index >= payloads.size()) {
+            break;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        stats.checksum += processSymbol(payloads[index], options, dotsPerModule);
+        stats.latencies.push_back(getSecondsSince(start) * 1e6);
+    }
+
+    // The latency buffer was reserved up front, so it does not count as pipeline allocations
+    stats.allocations = threadAllocationCount - allocationsBefore;
+    result = stats;
+}
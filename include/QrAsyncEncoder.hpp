@@ -0,0 +1,164 @@
+/*
+Services running on an event loop cannot call the blocking selectors
+inline for large payloads, but handing every tiny payload to another
+thread costs more than encoding it. This code encodes small payloads
+(up to QrEncodeOptions::asyncInlineLength bytes) directly on the calling
+thread and hands larger ones to an executor supplied by the caller, such
+as the worker pool of the event loop. Completion is reported through a
+callback or a std::future, so callers can wrap it in whatever awaitable
+their loop uses; the library itself stays C++11.
+
+Requests can be cancelled through a shared token. A cancelled request
+which has not started yet completes with QrCancelledException instead
+of being encoded. Batches of requests complete once, after the last one
+finished, with the result or error of every payload.
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "QrEncodeOptions.hpp"
+#include "QrModeSelector.hpp"
+
+/**
+ * Exception reported for requests cancelled before they were encoded.
+ */
+class QrCancelledException : public std::runtime_error {
+public:
+    /**
+     * Constructs a QrCancelledException with a specific error message.
+     *
+     * @param message The error message describing the cancelled request.
+     */
+    explicit QrCancelledException(const std::string& message);
+};
+
+/**
+ * Mode and version selected for a payload.
+ */
+struct QrEncodeResult {
+    QrMode mode;
+    int version;
+};
+
+/**
+ * Runs a task, now or later, on any thread.
+ */
+typedef std::function<void(std::function<void()>)> QrExecutor;
+
+/**
+ * Receives the result of a request, or the exception which stopped it (result is then unspecified).
+ */
+typedef std::function<void(const QrEncodeResult& result, std::exception_ptr error)> QrEncodeCallback;
+
+/**
+ * Receives the results of a batch; errors[i] is null if payload i was encoded.
+ */
+typedef std::function<void(const std::vector<QrEncodeResult>& results, const std::vector<std::exception_ptr>& errors)> QrBatchCallback;
+
+/**
+ * Shared flag for cancelling requests. Copies refer to the same flag.
+ */
+class QrCancellationToken {
+public:
+    /**
+     * Creates a token which is not cancelled.
+     */
+    QrCancellationToken();
+
+    /**
+     * Cancels all requests holding this token which have not started yet.
+     */
+    void cancel();
+
+    /**
+     * @return True if the token was cancelled; false otherwise.
+     */
+    bool isCancelled() const;
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled;
+};
+
+/**
+ * Utility class for encoding payloads without blocking the caller on large ones.
+ */
+class QrAsyncEncoder {
+public:
+    /**
+     * Encodes a payload on the calling thread.
+     *
+     * @param payload The payload.
+     * @param options The encode options.
+     * @return The selected mode and version.
+     * @throws std::invalid_argument if the payload cannot be encoded.
+     */
+    static QrEncodeResult encode(const std::string& payload, const QrEncodeOptions& options);
+
+    /**
+     * Checks if a payload is small enough to be encoded on the calling thread.
+     *
+     * @param payload The payload.
+     * @param options The encode options holding the inline length.
+     * @return True if the payload is encoded inline; false if it is handed to the executor.
+     */
+    static bool runsInline(const std::string& payload, const QrEncodeOptions& options);
+
+    /**
+     * Encodes a payload inline or on the executor and reports the outcome to the callback.
+     * The callback runs on the thread which encoded the payload.
+     *
+     * @param payload The payload.
+     * @param options The encode options.
+     * @param executor Runs large requests; an empty executor runs every request inline.
+     * @param token Cancels the request if it has not started yet.
+     * @param callback Receives the result or the exception.
+     */
+    static void encodeAsync(const std::string& payload, const QrEncodeOptions& options, const QrExecutor& executor,
+                            const QrCancellationToken& token, const QrEncodeCallback& callback);
+
+    /**
+     * Encodes a payload inline or on the executor.
+     *
+     * @param payload The payload.
+     * @param options The encode options.
+     * @param executor Runs large requests; an empty executor runs every request inline.
+     * @param token Cancels the request if it has not started yet.
+     * @return A future holding the result or the exception.
+     */
+    static std::future<QrEncodeResult> encodeAsync(const std::string& payload, const QrEncodeOptions& options,
+                                                   const QrExecutor& executor,
+                                                   const QrCancellationToken& token = QrCancellationToken());
+
+    /**
+     * Encodes a batch of payloads, each inline or on the executor, and reports all outcomes at once.
+     * The callback runs once, on the thread which finished the last payload. If the executor throws
+     * instead of accepting a task, that payload and all later ones are not submitted and report its exception.
+     * Exceptions thrown by the callback propagate from the call which ran it, which is this one if the last
+     * payload runs on the calling thread.
+     *
+     * @param payloads The payloads.
+     * @param options The encode options used for all payloads.
+     * @param executor Runs large requests; an empty executor runs every request inline.
+     * @param token Cancels the requests which have not started yet.
+     * @param callback Receives the results and errors in payload order.
+     */
+    static void encodeBatchAsync(const std::vector<std::string>& payloads, const QrEncodeOptions& options,
+                                 const QrExecutor& executor, const QrCancellationToken& token, const QrBatchCallback& callback);
+
+private:
+    /**
+     * Encodes a payload unless the token was cancelled and reports the outcome to the callback.
+     */
+    static void run(const std::string& payload, const QrEncodeOptions& options, const QrCancellationToken& token,
+                    const QrEncodeCallback& callback);
+};
@@ -0,0 +1,145 @@
+/*
+Large batches of similar payloads (serial numbers, product labels)
+usually resolve to the same version and error correction level. Such
+symbols share every size dependent parameter, so they can be processed
+together. This code groups a batch by version into groups of up to 64
+symbols and converts each group into a bit-sliced layout: every 64 bit
+word holds one bit position of all symbols in the group, one symbol per
+bit lane. Plain bitwise operations on these words then work on all
+symbols of the group at once.
+
+Mask selection is the first stage run this way. A group's symbols are
+sliced into one word per module position, each mask flips whole words,
+and the four penalty rules are evaluated with bitwise operations whose
+per-lane results are summed in bit-sliced counters. The scores match
+QrMaskSelector::getPenalty exactly; BenchQrBitSliced compares the two.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "QrMaskSelector.hpp"
+#include "QrModeSelector.hpp"
+#include "QrVersionSelector.hpp"
+
+/**
+ * A group of payloads which resolved to the same version and error correction level.
+ */
+struct QrBatchGroup {
+    QrErrorCorrectionLevel level;   ///< Error correction level shared by the group.
+    int version;                    ///< Version shared by the group.
+    std::vector<size_t> indices;    ///< Indices of the payloads in the batch, one per lane.
+    std::vector<QrMode> modes;      ///< Encoding mode of each lane.
+};
+
+/**
+ * Result of grouping a batch of payloads.
+ */
+struct QrBatchPlan {
+    std::vector<QrBatchGroup> groups;   ///< Groups ordered by version, each with at most LaneCount lanes.
+    std::vector<size_t> rejected;       ///< Indices of payloads which cannot be encoded in any version.
+};
+
+/**
+ * Utility class for grouping batches of payloads and converting them to and from bit-sliced form.
+ */
+class QrBitSlicedBatch {
+public:
+    /// Number of symbols processed together, one per bit of a 64 bit word.
+    static const size_t LaneCount = 64;
+
+    /**
+     * Groups payloads by the version selected by QrVersionSelector.
+     * Payloads which are empty, invalid or too long are reported as rejected instead of throwing.
+     *
+     * @param payloads The payloads to group.
+     * @param level The error correction level used for all payloads.
+     * @return The grouping, with lanes in each group kept in batch order.
+     */
+    static QrBatchPlan group(const std::vector<std::string>& payloads, QrErrorCorrectionLevel level);
+
+    /**
+     * Converts up to LaneCount byte strings to bit-sliced form.
+     * Bit i of word (8 * byte + bit) is bit `bit` (most significant first) of byte `byte` of lane i.
+     * Shorter lanes and missing lanes are padded with zero bits.
+     *
+     * @param lanes The byte strings, one per lane.
+     * @return The bit planes, 8 words per byte position, rounded up to a multiple of 64 words.
+     * @throws std::invalid_argument if more than LaneCount lanes are given.
+     */
+    static std::vector<uint64_t> transpose(const std::vector<std::string>& lanes);
+
+    /**
+     * Converts bit-sliced data back to byte strings.
+     *
+     * @param planes The bit planes produced by transpose.
+     * @param lengths The length in bytes of each lane to extract.
+     * @return The byte strings, one per entry in lengths.
+     * @throws std::invalid_argument if more than LaneCount lanes are requested or planes are too short.
+     */
+    static std::vector<std::string> untranspose(const std::vector<uint64_t>& planes, const std::vector<size_t>& lengths);
+
+    /**
+     * Computes the penalty scores of up to LaneCount masked symbols of the same size at once.
+     *
+     * @param symbols The masked symbols.
+     * @return The score of each symbol, equal to QrMaskSelector::getPenalty.
+     * @throws std::invalid_argument if more than LaneCount symbols are given or their sizes differ.
+     */
+    static std::vector<int> getPenalties(const std::vector<QrModuleMatrix>& symbols);
+
+    /**
+     * Selects the mask of up to LaneCount symbols of the same size at once, scoring every mask on the whole symbol.
+     * Gives the same masks and penalties as the Exhaustive strategy of QrMaskSelector.
+     *
+     * @param symbols The unmasked symbols.
+     * @param reserved Matrix of the same size whose dark modules mark function patterns.
+     * @return The selected mask and its penalty for each symbol; the penalty delta is not measured.
+     * @throws std::invalid_argument if more than LaneCount symbols are given or their sizes differ.
+     */
+    static std::vector<QrMaskSelection> selectMasks(const std::vector<QrModuleMatrix>& symbols, const QrModuleMatrix& reserved);
+
+private:
+    /// Bits of the bit-sliced score counters, enough for any score of a version 40 symbol.
+    static const int CounterBits = 24;
+
+    /**
+     * Converts symbols to one word per module position, row by row, with one symbol per bit lane.
+     */
+    static std::vector<uint64_t> sliceSymbols(const std::vector<QrModuleMatrix>& symbols, int size);
+
+    /**
+     * Computes the penalty scores of all lanes of bit-sliced symbols.
+     */
+    static std::vector<int> scorePlanes(const std::vector<uint64_t>& planes, int size, size_t laneCount);
+
+    /**
+     * Adds the run (N1) and finder-like pattern (N3) scores of one bit-sliced line to the counters.
+     */
+    static void scoreLine(const uint64_t* line, size_t step, int size, uint64_t* counter);
+
+    /**
+     * Adds one bit per lane, weighted by a power of two, to bit-sliced counters.
+     */
+    static void addToCounter(uint64_t* counter, uint64_t bits, int weightBit);
+
+    /**
+     * Validates the lane count and sizes of a group of symbols and returns their size.
+     */
+    static int checkSymbols(const std::vector<QrModuleMatrix>& symbols);
+
+    /**
+     * Reverses the order of the bits within every byte of a word.
+     */
+    static uint64_t reverseByteBits(uint64_t word);
+
+    /**
+     * Transposes a 64x64 bit matrix in place, where bit c of word r is element (r, c).
+     */
+    static void transpose64(uint64_t* block);
+};
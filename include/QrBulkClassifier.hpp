@@ -0,0 +1,160 @@
+/*
+Catalog preprocessing classifies millions of short strings (SKUs, IDs)
+at once. Calling QrModeSelector and QrVersionSelector per string spends
+most of the time on call overhead and string copies. This code takes a
+whole string column in the Arrow layout (one byte buffer plus row
+offsets) and classifies it in one pass:
+
+- the bytes of a row are classified a vector register at a time: the
+  classes of each byte come from two 16 entry tables indexed by its
+  nibbles with a byte shuffle, and the mode of the row follows from
+  whether any byte lacks the digit, alphanumeric or ASCII class,
+- without vector instructions, leading digits are checked eight bytes at
+  a time in a 64 bit word and the other bytes go through a byte class
+  table,
+- rows with bytes above 0x7F fall back to the full UTF-8 and Shift JIS
+  validators,
+- the version is the number of capacities in the (level, mode) column of
+  the capacity table which are smaller than the row length, compared a
+  register at a time.
+
+Rows are not transposed to put one row in each vector lane: they have
+different lengths, so the transposition would cost a store per byte,
+more than classifying the row where it is.
+
+Each row kernel is written for one QrCpuLevel and the one matching the
+CPU is used. calibrate optionally times the kernels and the cost of
+handing tasks to other threads on the running machine, and caches the
+result in a file so later starts only read it. The result also sets the
+version from which QrMaskSelector scores its candidates on several
+threads.
+*/
+
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "QrCpuDispatch.hpp"
+#include "QrModeSelector.hpp"
+#include "QrVersionSelector.hpp"
+
+/**
+ * Exception thrown when the offsets of a string column do not describe rows of its byte buffer.
+ */
+class InvalidColumnException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidColumnException with a specific error message.
+     *
+     * @param message The error message describing the invalid offsets.
+     */
+    explicit InvalidColumnException(const std::string& message);
+};
+
+/**
+ * Mode and version of one row.
+ */
+struct QrBulkClassification {
+    QrMode mode;    ///< The mode selected by QrModeSelector; ByteMode for empty or invalid rows.
+    int version;    ///< The version selected by QrVersionSelector, or 0 if the row cannot be encoded.
+};
+
+/**
+ * Machine dependent settings of the classifier.
+ */
+struct QrBulkTuning {
+    QrCpuLevel kernelLevel;         ///< Instruction set level of every dispatched kernel, see QrCpuDispatch::setKernelLevel.
+    size_t parallelThreshold;       ///< Columns with fewer rows are classified on the calling thread only.
+    int parallelVersionThreshold;   ///< Default smallest version using the thread budget, see QrParallel::setVersionThreshold.
+};
+
+/**
+ * Utility class for classifying whole string columns.
+ */
+class QrBulkClassifier {
+public:
+    /**
+     * Classifies every row of an Arrow style string column.
+     * Row i consists of the bytes [offsets[i], offsets[i + 1]).
+     *
+     * @param offsets The rowCount + 1 row offsets into bytes.
+     * @param bytes The concatenated row bytes.
+     * @param rowCount Number of rows.
+     * @param level The error correction level used for all rows.
+     * @param results Receives rowCount classifications.
+     * @param threadCount Maximum number of threads classifying blocks of rows.
+     * @throws InvalidColumnException if an offset is negative or smaller than the one before it.
+     */
+    static void classify(const int32_t* offsets, const char* bytes, size_t rowCount, QrErrorCorrectionLevel level,
+                         QrBulkClassification* results, int threadCount = 1);
+
+    /**
+     * Classifies every row of an Arrow style string column.
+     *
+     * @param offsets The row offsets; the column has offsets.size() - 1 rows.
+     * @param bytes The concatenated row bytes.
+     * @param level The error correction level used for all rows.
+     * @param threadCount Maximum number of threads classifying blocks of rows.
+     * @return One classification per row.
+     * @throws InvalidColumnException if an offset is negative, smaller than the one before it or past the end of bytes.
+     */
+    static std::vector<QrBulkClassification> classify(const std::vector<int32_t>& offsets, const std::vector<char>& bytes,
+                                                      QrErrorCorrectionLevel level, int threadCount = 1);
+
+    /**
+     * @return The settings in use. Until setTuning or calibrate is called, the kernels of the detected
+     *         CPU level, a threshold of one task of rows and a version threshold of 30 are used.
+     */
+    static QrBulkTuning getTuning();
+
+    /**
+     * Sets the settings used by classify, the kernel level of every dispatched kernel and the default
+     * parallel version threshold.
+     *
+     * @param tuning The settings.
+     * @throws UnsupportedCpuLevelException if this CPU cannot run the kernel level.
+     */
+    static void setTuning(const QrBulkTuning& tuning);
+
+    /**
+     * Picks the fastest kernel level and the parallel thresholds for this machine and sets them.
+     * If the cache file holds settings measured on a machine with the same CPU level and core count,
+     * they are used without measuring. Otherwise the settings are measured, which takes a few
+     * milliseconds, and written to the cache file; a cache which cannot be written is ignored.
+     * A process measures at most once. The settings are published with setTuning, so classify calls
+     * running meanwhile finish with the settings they started with.
+     *
+     * @param cachePath The cache file, or an empty string to measure without a cache.
+     * @return The settings now in use.
+     */
+    static QrBulkTuning calibrate(const std::string& cachePath);
+
+private:
+    /// Number of rows classified by one task.
+    static const size_t RowsPerTask = 4096;
+
+    /**
+     * Checks that the offsets are not negative and do not decrease.
+     */
+    static void checkOffsets(const int32_t* offsets, size_t rowCount);
+
+    /**
+     * Measures the settings for this machine.
+     */
+    static QrBulkTuning measureTuning();
+
+    /**
+     * Reads settings from the cache file, returning false if it is missing, corrupted or from another machine.
+     */
+    static bool readTuning(const std::string& path, QrBulkTuning& tuning);
+
+    /**
+     * Writes settings to the cache file atomically by renaming a temporary file over it.
+     */
+    static void writeTuning(const std::string& path, const QrBulkTuning& tuning);
+};
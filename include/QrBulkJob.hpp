@@ -0,0 +1,183 @@
+/*
+Bulk jobs process input files with one message per line. Large jobs are
+split into shards which can run in separate processes or on separate
+machines. Every shard covers a byte range of the input aligned to line
+boundaries, so the split is deterministic and needs no coordination.
+A shard writes its results together with a checkpoint manifest, which
+lets an interrupted shard resume where it stopped. Since shards cover
+consecutive byte ranges, their outputs merge into one ordered result by
+concatenation after validating the manifests.
+
+Each output line records the byte offset and length of the input record
+followed by the selected mode and version and the mask of the job:
+
+    <offset>\t<length>\t<mode>\t<version>\t<mask>
+
+Records which cannot be encoded get the mode "invalid" and version 0.
+The mask is the fixed mask (0-7) of QrMaskStrategy::Fixed, or "auto" when
+the encoder scores the masks. The manifest records the job options too, so
+merging rejects shards written with a different level or mask, and every
+record must agree with them.
+
+A checkpoint syncs the output, the manifest and its directory, so it costs
+three fsyncs. Checkpoints are taken after a number of input bytes rather
+than records; the default of 8 MiB keeps the fsyncs rare for short records
+and bounds the work repeated after a crash.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <stdexcept>
+
+#include "QrEncodeOptions.hpp"
+
+/**
+ * Exception thrown when a shard specification, input file or shard output is invalid.
+ */
+class InvalidShardException : public std::runtime_error {
+public:
+    /**
+     * Constructs an InvalidShardException with a specific error message.
+     *
+     * @param message The error message describing the problem.
+     */
+    explicit InvalidShardException(const std::string& message);
+};
+
+/**
+ * Selects shard `index` out of `count` shards (0 <= index < count).
+ */
+struct QrShardSpec {
+    int index;
+    int count;
+};
+
+/**
+ * Half-open byte range [begin, end) of the input file.
+ */
+struct QrByteRange {
+    uint64_t begin;
+    uint64_t end;
+};
+
+/**
+ * Utility class for running sharded, resumable bulk jobs.
+ */
+class QrBulkJob {
+public:
+    /// Default number of input bytes processed between checkpoints.
+    static const uint64_t DefaultCheckpointBytes = 8 << 20;
+
+    /**
+     * Parses a shard specification written as "index/count".
+     *
+     * @param spec The specification, for example "2/8".
+     * @return The parsed shard.
+     * @throws InvalidShardException if the specification is malformed or out of range.
+     */
+    static QrShardSpec parseShardSpec(const std::string& spec);
+
+    /**
+     * Computes the byte range of the input handled by a shard.
+     * A shard handles every record which starts inside its nominal range of size / count bytes.
+     *
+     * @param inputPath The input file.
+     * @param shard The shard.
+     * @return The range, starting and ending at record boundaries.
+     * @throws InvalidShardException if the shard is out of range or the input cannot be read.
+     */
+    static QrByteRange getShardRange(const std::string& inputPath, const QrShardSpec& shard);
+
+    /**
+     * Processes the records of a shard, resuming from the checkpoint manifest if one exists.
+     *
+     * @param inputPath The input file.
+     * @param outputPath The output file of the shard. The manifest is written next to it.
+     * @param shard The shard.
+     * @param options The encode options; the error correction level is used for version selection and the mask
+     *        strategy and fixed mask for the mask column.
+     * @param checkpointBytes Number of input bytes processed between checkpoints.
+     * @return The total number of records in the shard output.
+     * @throws InvalidShardException if the input or output cannot be accessed, the manifest belongs to another job
+     *         or the output is shorter than the manifest records.
+     */
+    static size_t run(const std::string& inputPath, const std::string& outputPath, const QrShardSpec& shard,
+                      const QrEncodeOptions& options, uint64_t checkpointBytes = DefaultCheckpointBytes);
+
+    /**
+     * Validates complete shard outputs and concatenates them into one ordered result.
+     *
+     * @param shardOutputs Output files of all shards, ordered by shard index.
+     * @param mergedPath The merged output file.
+     * @return The number of merged records.
+     * @throws InvalidShardException if a shard is missing, incomplete, does not continue the previous one, was written
+     *         with other options than the first shard, or holds a record which does not match its options.
+     */
+    static size_t merge(const std::vector<std::string>& shardOutputs, const std::string& mergedPath);
+
+    /**
+     * @param outputPath The output file of a shard.
+     * @return The path of its checkpoint manifest.
+     */
+    static std::string getManifestPath(const std::string& outputPath);
+
+private:
+    /**
+     * Progress of a shard as stored in its manifest.
+     */
+    struct Manifest {
+        QrShardSpec shard;
+        QrByteRange range;
+        uint64_t nextOffset;
+        uint64_t outputBytes;
+        size_t records;
+        bool complete;
+        QrEncodeOptions options;    ///< Only the level, mask strategy and fixed mask are stored.
+    };
+
+    /**
+     * Finds the first record boundary at or after the offset.
+     */
+    static uint64_t alignToRecord(const std::string& inputPath, uint64_t offset, uint64_t fileSize);
+
+    /**
+     * Reads a manifest, returning false if it does not exist.
+     */
+    static bool readManifest(const std::string& path, Manifest& manifest);
+
+    /**
+     * Writes a manifest atomically by renaming a temporary file over it.
+     */
+    static void writeManifest(const std::string& path, const Manifest& manifest);
+
+    /**
+     * Flushes a file or directory to disk with fsync.
+     */
+    static void syncFile(const std::string& path);
+
+    /**
+     * Checks whether two jobs use the same level and mask.
+     */
+    static bool isSameJob(const QrEncodeOptions& first, const QrEncodeOptions& second);
+
+    /**
+     * Formats the mask column of the output for the options.
+     */
+    static std::string formatMask(const QrEncodeOptions& options);
+
+    /**
+     * Formats the output line of one record.
+     */
+    static std::string formatRecord(uint64_t offset, const std::string& record, const QrEncodeOptions& options);
+
+    /**
+     * Checks that the mode, version and mask of an output line agree with the job options.
+     */
+    static bool isConsistentRecord(std::istream& fields, uint64_t length, const QrEncodeOptions& options);
+};
@@ -0,0 +1,90 @@
+/*
+The data and error correction codewords are placed into the symbol in a
+zig-zag: two module wide columns are walked from the bottom right corner
+upwards, then downwards, and so on to the left, skipping every module
+used by a function pattern (finder, separator, timing and alignment
+patterns, format and version information). The walk only depends on the
+version, so this code performs it once per version and stores where each
+bit goes as a (row, word, bit) position in the packed module matrix.
+Placing codewords then becomes a plain table driven scatter.
+
+The tables are built on first use and never change afterwards, so they
+can be shared by all threads.
+*/
+
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "QrModuleMatrix.hpp"
+
+/**
+ * Position of one module in a packed QrModuleMatrix.
+ */
+struct QrModulePosition {
+    uint8_t row;    ///< Row of the module.
+    uint8_t word;   ///< Index of the word within the row.
+    uint8_t bit;    ///< Index of the bit within the word.
+};
+
+/**
+ * Placement of codeword bits for one version.
+ */
+struct QrPlacementTable {
+    int version;                                ///< The version (1-40).
+    QrModuleMatrix reserved;                    ///< Dark modules mark function patterns.
+    std::vector<QrModulePosition> positions;    ///< Position of every data bit, in placement order.
+};
+
+/**
+ * Utility class providing the per version placement tables and placing codewords with them.
+ */
+class QrCodewordPlacement {
+public:
+    /**
+     * Returns the placement table of a version, building it on first use.
+     * The table is immutable and shared between all callers and threads.
+     *
+     * @param version The version selected by QrVersionSelector::getQrVersion.
+     * @return The placement table.
+     * @throws InvalidVersionException if the version is outside of 1-40.
+     */
+    static const QrPlacementTable& getTable(int version);
+
+    /**
+     * Writes codeword bits, most significant bit first, into the data modules of the matrix.
+     * Data modules not covered by the codewords (the remainder bits) are left unchanged.
+     *
+     * @param codewords The interleaved data and error correction codewords.
+     * @param table The placement table of the matrix version.
+     * @param matrix The matrix receiving the bits.
+     * @throws std::invalid_argument if there are more codeword bits than data modules or the matrix has the wrong size.
+     */
+    static void placeCodewords(const std::vector<uint8_t>& codewords, const QrPlacementTable& table, QrModuleMatrix& matrix);
+
+    /**
+     * Returns the centre coordinates of the alignment patterns of a version.
+     *
+     * @param version The version (1-40).
+     * @return The coordinates used for both rows and columns; empty for version 1.
+     */
+    static std::vector<int> getAlignmentPositions(int version);
+
+private:
+    /**
+     * Builds the placement table of a version.
+     */
+    static QrPlacementTable buildTable(int version);
+
+    /**
+     * Marks the modules used by function patterns.
+     */
+    static void reserveFunctionPatterns(int version, QrModuleMatrix& reserved);
+
+    /**
+     * Marks a rectangle of modules, clipped to the matrix.
+     */
+    static void reserveRectangle(QrModuleMatrix& reserved, int top, int left, int height, int width);
+};
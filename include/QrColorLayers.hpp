@@ -0,0 +1,141 @@
+/*
+In closed systems, where both the printer or screen and the camera are
+under our control, a symbol can carry three ordinary QR layers at once,
+one per color channel. This roughly triples the capacity per area. The
+mode is experimental and non-standard; no ordinary reader decodes it, so
+it has to be enabled through QrEncodeOptions::colorModel.
+
+The payload is split into three parts of about the same byte length, at
+character boundaries of its mode, so every part stays valid on its own
+(UTF-8 sequences and Shift JIS pairs are never cut). Each part gets its
+own mode and version; the symbol uses the largest version, since the
+layers must be the same size.
+
+Layers are multiplexed either into an RGB image for screens (layer i
+dark = channel i off, so all three dark give black) or into cyan,
+magenta and yellow ink separations for print. The matching readers
+separate the channels again. Image rows are produced with QrRowRenderer,
+so writing a symbol needs one scanline per layer.
+*/
+
+
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "QrEncodeOptions.hpp"
+#include "QrModeSelector.hpp"
+#include "QrModuleMatrix.hpp"
+
+/**
+ * Exception thrown when a payload, layer set or image cannot be used for color layers.
+ */
+class InvalidColorLayerException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidColorLayerException with a specific error message.
+     *
+     * @param message The error message describing the problem.
+     */
+    explicit InvalidColorLayerException(const std::string& message);
+};
+
+/**
+ * Parts of a payload and the mode and version selected for each layer.
+ */
+struct QrColorLayerPlan {
+    std::vector<std::string> layers;    ///< The payload parts, in layer order.
+    std::vector<QrMode> modes;          ///< The mode of every layer.
+    std::vector<int> versions;          ///< The smallest version of every layer.
+    int version;                        ///< The version of the symbol, the largest layer version.
+};
+
+/**
+ * Utility class for experimental three-layer color symbols.
+ */
+class QrColorLayers {
+public:
+    /// Number of layers in a color symbol.
+    static const int LayerCount = 3;
+
+    /**
+     * Splits a payload into LayerCount parts at character boundaries of its mode.
+     *
+     * @param payload The payload.
+     * @return The parts in layer order; concatenated they give the payload.
+     * @throws EmptyInputMessageException if the payload is empty.
+     * @throws InvalidInputMessageException if the payload cannot be encoded in any mode.
+     * @throws InvalidColorLayerException if the payload has fewer than LayerCount characters.
+     */
+    static std::vector<std::string> splitPayload(const std::string& payload);
+
+    /**
+     * Splits a payload and selects the mode and version of every layer.
+     *
+     * @param payload The payload.
+     * @param options The encode options; colorModel must not be QrColorModel::None.
+     * @return The plan of the symbol.
+     * @throws InvalidColorLayerException if color layers are not enabled or the payload is too short.
+     * @throws TooLongMessageException if a layer does not fit in any version.
+     */
+    static QrColorLayerPlan plan(const std::string& payload, const QrEncodeOptions& options);
+
+    /**
+     * Joins decoded layers back into the payload.
+     *
+     * @param layers The layer contents in layer order.
+     * @return The payload.
+     */
+    static std::string joinLayers(const std::vector<std::string>& layers);
+
+    /**
+     * Writes the layers as a color image: a binary PPM (P6) for QrColorModel::Rgb, or three binary
+     * PBM (P4) ink separations, cyan, magenta and yellow, for QrColorModel::Cmy.
+     *
+     * @param layers LayerCount module matrices of the same size.
+     * @param model The color model of the image.
+     * @param dotsPerModule Width and height of one module in pixels.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @param out The stream receiving the image.
+     * @throws InvalidColorLayerException if the layers, model or scale are invalid.
+     */
+    static void writeImage(const std::vector<QrModuleMatrix>& layers, QrColorModel model, int dotsPerModule, int quietZone,
+                           std::ostream& out);
+
+    /**
+     * Reads the layers back from an image written by writeImage, sampling the centre of every module.
+     *
+     * @param in The stream holding the image.
+     * @param model The color model of the image.
+     * @param dotsPerModule Width and height of one module in pixels.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @return LayerCount module matrices.
+     * @throws InvalidColorLayerException if the image is malformed or does not match the scale.
+     */
+    static std::vector<QrModuleMatrix> readImage(std::istream& in, QrColorModel model, int dotsPerModule, int quietZone);
+
+private:
+    /**
+     * Returns the byte offsets where characters of the payload start, for the given mode.
+     */
+    static std::vector<size_t> getCharacterStarts(const std::string& payload, QrMode mode);
+
+    /**
+     * Checks that the layers have the same size and the scale is valid.
+     */
+    static void checkLayers(const std::vector<QrModuleMatrix>& layers, int dotsPerModule, int quietZone);
+
+    /**
+     * Reads the header of a binary netpbm image and returns its width and height.
+     */
+    static void readHeader(std::istream& in, const std::string& magic, int& width, int& height);
+
+    /**
+     * Computes the symbol size from the image size, checking that it matches the scale.
+     */
+    static int getSymbolSize(int width, int height, int dotsPerModule, int quietZone);
+};
@@ -0,0 +1,109 @@
+/*
+The library is built for one generic target, but the machines running it
+range from SSE4.2 to AVX-512. The hot kernel of the bulk classifier is
+therefore written once per instruction set level with that level's
+vector instructions, and the variant is picked at run time from what the
+CPU reports. Loops the compiler cannot widen, such as the mask penalty
+and the row renderer expansion, stay scalar: compiling them per level
+would only add a dispatch. This code detects the level and holds the
+level the kernels use, which QrBulkClassifier::calibrate may lower.
+Variants are only built with GCC or Clang on x86; elsewhere every kernel
+has just its generic variant.
+*/
+
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+/// Defined when kernels can be compiled for several instruction set levels.
+#define CPP_QR_CPU_VARIANTS 1
+/// Compiles one function for the given instruction sets, for example CPP_QR_TARGET(CPP_QR_ISA_AVX2).
+#define CPP_QR_TARGET(isa) __attribute__((target(isa)))
+/// Inlines a kernel body into every variant, so each variant is compiled for its own instruction sets.
+#define CPP_QR_FORCE_INLINE inline __attribute__((always_inline))
+#else
+#define CPP_QR_FORCE_INLINE inline
+#endif
+
+/// Instruction sets of the Sse42 variants; detectLevel checks every one of them.
+#define CPP_QR_ISA_SSE42 "sse4.2,popcnt"
+/// Instruction sets of the Avx2 variants; detectLevel checks every one of them.
+#define CPP_QR_ISA_AVX2 "sse4.2,popcnt,avx2,bmi,bmi2"
+/// Instruction sets of the Avx512 variants; detectLevel checks every one of them.
+#define CPP_QR_ISA_AVX512 "sse4.2,popcnt,avx2,bmi,bmi2,avx512f,avx512bw,avx512vl"
+
+/**
+ * Enum representing the instruction set levels kernels are compiled for, in increasing order.
+ */
+enum class QrCpuLevel {
+    Generic,    ///< The build target of the library.
+    Sse42,      ///< SSE4.2 and POPCNT.
+    Avx2,       ///< Sse42 plus AVX2, BMI and BMI2.
+    Avx512      ///< Avx2 plus AVX-512 F, BW and VL.
+};
+
+/**
+ * Exception thrown when a kernel variant is requested which this CPU cannot run.
+ */
+class UnsupportedCpuLevelException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an UnsupportedCpuLevelException with a specific error message.
+     *
+     * @param message The error message describing the unsupported level.
+     */
+    explicit UnsupportedCpuLevelException(const std::string& message);
+};
+
+/**
+ * Utility class for detecting the instruction set level of the CPU and selecting the level of the kernels.
+ */
+class QrCpuDispatch {
+public:
+    /**
+     * Detects the highest level supported by both the CPU and the build. The result is cached.
+     *
+     * @return The detected level.
+     */
+    static QrCpuLevel detectLevel();
+
+    /**
+     * Checks if kernels of the given level can run on this CPU.
+     *
+     * @param level The level.
+     * @return True if the level is at most the detected one; false otherwise.
+     */
+    static bool isSupported(QrCpuLevel level);
+
+    /**
+     * @return The level of the kernel variants used by every dispatched kernel; the detected level until
+     *         setKernelLevel is called.
+     */
+    static QrCpuLevel getKernelLevel();
+
+    /**
+     * Sets the level of the kernel variants used by every dispatched kernel.
+     *
+     * @param level The level.
+     * @throws UnsupportedCpuLevelException if this CPU cannot run kernels of the level.
+     */
+    static void setKernelLevel(QrCpuLevel level);
+
+    /**
+     * @param level The level.
+     * @return The name of the level: "generic", "sse4.2", "avx2" or "avx512".
+     */
+    static std::string getLevelName(QrCpuLevel level);
+
+    /**
+     * Parses the name of a level.
+     *
+     * @param name The name as returned by getLevelName.
+     * @param level Receives the level.
+     * @return True if the name is known; false otherwise.
+     */
+    static bool parseLevelName(const std::string& name, QrCpuLevel& level);
+};
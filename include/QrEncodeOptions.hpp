@@ -0,0 +1,47 @@
+/*
+Options controlling how a message is encoded into a QR symbol.
+Besides the error correction level, the encoder has to pick one of eight
+mask patterns. Scoring all of them gives the symbol which is easiest to
+scan, but costs time; the mask strategy trades scan reliability for
+encoding speed. Large symbols may also spread their independent work
+over a few threads. Closed systems may opt in to non-standard color
+symbols carrying three layers.
+*/
+
+
+#pragma once
+
+#include "QrVersionSelector.hpp"
+
+/**
+ * Enum representing the ways of choosing the mask pattern of a symbol.
+ */
+enum class QrMaskStrategy {
+    Exhaustive,     ///< Score all eight masks on the whole symbol (ISO 18004 behaviour).
+    Fast,           ///< Score masks on sampled rows and columns, dropping candidates once they exceed the best score.
+    Fixed           ///< Always use QrEncodeOptions::fixedMask.
+};
+
+/**
+ * Enum representing the experimental multi-layer color symbols.
+ */
+enum class QrColorModel {
+    None,           ///< Standard single-layer symbol.
+    Rgb,            ///< Three layers in the red, green and blue channels of an image for screens.
+    Cmy             ///< Three layers printed as cyan, magenta and yellow ink separations.
+};
+
+/**
+ * Options used when encoding a message.
+ */
+struct QrEncodeOptions {
+    QrErrorCorrectionLevel level = QrErrorCorrectionLevel::MEDIUM;  ///< Error correction level.
+    QrMaskStrategy maskStrategy = QrMaskStrategy::Exhaustive;       ///< How the mask pattern is chosen.
+    int fixedMask = 0;                  ///< Mask pattern (0-7) used by QrMaskStrategy::Fixed.
+    int sampleStride = 4;               ///< QrMaskStrategy::Fast scores every sampleStride-th row and column.
+    bool measurePenaltyDelta = false;   ///< Also run the exhaustive selection to report the penalty lost by the strategy.
+    int threadBudget = 1;               ///< Maximum number of threads a single encode may use.
+    int parallelVersionThreshold = 0;   ///< Smallest version for which the thread budget is used; 0 for QrParallel::getVersionThreshold.
+    int asyncInlineLength = 256;        ///< QrAsyncEncoder encodes payloads up to this many bytes on the calling thread.
+    QrColorModel colorModel = QrColorModel::None;   ///< Opt-in, non-standard multi-layer color symbols (QrColorLayers).
+};
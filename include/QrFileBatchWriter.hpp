@@ -0,0 +1,174 @@
+/*
+Some jobs need one image file per symbol. For millions of small files
+the open, write and close system calls cost more than rendering. This
+code collects the files of a batch in one large buffer: renderers write
+each image straight into its slice of the buffer, and the whole batch is
+written at once by one of three backends:
+
+- Posix writes the files one after another on the calling thread,
+- ThreadPool spreads the files of a batch over the threads of the
+  QrParallel pool,
+- IoUring submits open, write and close of every file as linked
+  requests to one io_uring, with the batch buffer registered with the
+  kernel, so a batch costs a few system calls instead of three per
+  file. Short writes are resumed and slots whose close was cancelled by
+  a failed write are closed explicitly. If the ring itself fails, the
+  requests in flight are drained before the error is reported, so the
+  kernel is done with the buffer. It is only built when liburing
+  2.2 or newer is found (CPP_QR_HAVE_LIBURING).
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "QrModuleMatrix.hpp"
+
+/**
+ * Exception thrown when a file of a batch cannot be written.
+ */
+class QrFileWriteException : public std::runtime_error {
+public:
+    /**
+     * Constructs a QrFileWriteException with a specific error message.
+     *
+     * @param message The error message describing the failed write.
+     */
+    explicit QrFileWriteException(const std::string& message);
+};
+
+/**
+ * Enum representing the ways of writing a batch of files.
+ */
+enum class QrFileBackend {
+    Posix,          ///< open, write and close per file on the calling thread.
+    ThreadPool,     ///< The Posix path spread over the threads of the QrParallel pool.
+    IoUring         ///< Linked open, write and close requests on one io_uring (needs liburing).
+};
+
+/**
+ * Options of a batch writer.
+ */
+struct QrFileBatchOptions {
+    size_t batchBytes = 8 << 20;    ///< Size of the batch buffer; a batch is written when it is full.
+    int threadCount = 4;            ///< Threads used by QrFileBackend::ThreadPool, including the calling one.
+    unsigned int queueDepth = 192;  ///< Submission queue entries used by QrFileBackend::IoUring.
+};
+
+/**
+ * Writes many small files in batches. Files are written by flush, or when the batch buffer is full.
+ */
+class QrFileBatchWriter {
+public:
+    /**
+     * Creates a writer using the given backend.
+     *
+     * @param backend The backend.
+     * @param options The batch options.
+     * @return The writer.
+     * @throws QrFileWriteException if the backend is not available or cannot be set up.
+     */
+    static std::unique_ptr<QrFileBatchWriter> create(QrFileBackend backend, const QrFileBatchOptions& options = QrFileBatchOptions());
+
+    /**
+     * Checks if a backend was built into the library.
+     *
+     * @param backend The backend.
+     * @return True if create accepts the backend; false otherwise.
+     */
+    static bool isAvailable(QrFileBackend backend);
+
+    /**
+     * Destroys the writer. Backends write the remaining files first, ignoring errors; call flush to see them.
+     */
+    virtual ~QrFileBatchWriter();
+
+    /**
+     * Reserves space for the next file in the batch buffer, writing the current batch first if it is full.
+     *
+     * @param size The size of the file in bytes.
+     * @return The buffer to fill, valid until commit.
+     * @throws QrFileWriteException if the file is larger than the batch buffer or a batch cannot be written.
+     */
+    unsigned char* reserve(size_t size);
+
+    /**
+     * Adds the file filled through the last reserve call to the batch.
+     *
+     * @param path The path of the file, created or truncated.
+     */
+    void commit(const std::string& path);
+
+    /**
+     * Renders a matrix as a binary PBM (P4) image straight into the batch buffer and adds it to the batch.
+     *
+     * @param path The path of the image file.
+     * @param matrix The modules to render.
+     * @param dotsPerModule Width and height of one module in pixels.
+     * @param quietZone Width of the light border around the symbol in modules.
+     */
+    void writePbm(const std::string& path, const QrModuleMatrix& matrix, int dotsPerModule, int quietZone);
+
+    /**
+     * Writes all files of the batch and waits for them.
+     *
+     * @throws QrFileWriteException if a file cannot be written; the batch is dropped.
+     */
+    void flush();
+
+    /**
+     * @return The number of files written so far.
+     */
+    uint64_t getFileCount() const;
+
+protected:
+    /**
+     * A file of the batch.
+     */
+    struct Entry {
+        std::string path;   ///< Path of the file.
+        size_t offset;      ///< Offset of the content in the batch buffer.
+        size_t size;        ///< Size of the content.
+    };
+
+    /**
+     * Creates a writer with a batch buffer of the given size.
+     */
+    explicit QrFileBatchWriter(const QrFileBatchOptions& options);
+
+    /**
+     * Writes all entries of a batch.
+     *
+     * @param entries The files of the batch.
+     * @param buffer The batch buffer holding their content.
+     * @throws QrFileWriteException if a file cannot be written.
+     */
+    virtual void writeBatch(const std::vector<Entry>& entries, const unsigned char* buffer) = 0;
+
+    /**
+     * Writes the remaining files, ignoring errors. Called by the destructors of the backends.
+     */
+    void flushQuietly();
+
+    /**
+     * Writes one file with open, write and close.
+     *
+     * @throws QrFileWriteException if the file cannot be written.
+     */
+    static void writeFile(const std::string& path, const unsigned char* data, size_t size);
+
+    QrFileBatchOptions options;
+    std::vector<unsigned char> buffer;  ///< The batch buffer; never reallocated, so it can be registered.
+
+private:
+    std::vector<Entry> entries;
+    size_t used;                        ///< Bytes of the buffer used by committed files.
+    size_t reserved;                    ///< Size of the pending reservation.
+    uint64_t fileCount;
+};
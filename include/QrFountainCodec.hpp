@@ -0,0 +1,181 @@
+/*
+Payloads of hundreds of kilobytes do not fit in one symbol, so they are
+shown as an animated sequence of symbols and read by a camera. Frames
+get lost or read out of order, so the sequence is fountain coded (LT
+code): the payload is split into equally sized blocks, and every frame
+carries the XOR of a pseudo-random set of blocks. The first frames carry
+the blocks themselves; later frames mix blocks with degrees drawn from
+the robust soliton distribution. A decoder reconstructs the payload from
+any sufficiently large set of distinct frames, usually a few percent more
+frames than there are blocks.
+
+Every frame starts with a header identifying the sequence:
+
+    payload length (4 bytes) | block size (2) | payload CRC-32 (4) | frame index (4)
+
+followed by one block. Sequences are limited to MaxPayloadLength bytes
+in MaxBlockCount blocks, so a forged header cannot make the decoder
+allocate without bound. The set of blocks mixed into a frame follows
+from the frame index and the CRC alone, so it is not transmitted. The
+frame is written in Base45 (RFC 9285), whose alphabet is the QR
+alphanumeric character set, so every frame is encoded in alphanumeric
+mode regardless of the payload bytes. Frames are independent, so they
+are built on several threads.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "QrEncodeOptions.hpp"
+#include "QrModeSelector.hpp"
+
+/**
+ * Exception thrown when sequence parameters or a received frame are invalid.
+ */
+class InvalidFountainDataException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidFountainDataException with a specific error message.
+     *
+     * @param message The error message describing the invalid data.
+     */
+    explicit InvalidFountainDataException(const std::string& message);
+};
+
+/**
+ * One frame of a fountain coded sequence.
+ */
+struct QrFountainFrame {
+    uint32_t index;     ///< Frame index within the sequence.
+    std::string text;   ///< Base45 text of the frame, the content of the symbol.
+    QrMode mode;        ///< Mode selected for the text (always alphanumeric).
+    int version;        ///< Version selected for the text.
+};
+
+/**
+ * Utility class for building fountain coded frame sequences.
+ */
+class QrFountainEncoder {
+public:
+    /// Size of the frame header in bytes.
+    static const size_t HeaderSize = 14;
+
+    /// Longest payload of a sequence in bytes.
+    static const size_t MaxPayloadLength = 16 << 20;
+
+    /// Largest number of blocks of a sequence.
+    static const size_t MaxBlockCount = 1 << 16;
+
+    /**
+     * Computes the largest block size whose frames fit in the given version.
+     *
+     * @param version The version of the frame symbols.
+     * @param level The error correction level of the frame symbols.
+     * @return The block size in bytes.
+     * @throws InvalidFountainDataException if the version is too small to hold any frame.
+     * @throws InvalidVersionException if the version is outside of 1-40.
+     */
+    static size_t getBlockSize(int version, QrErrorCorrectionLevel level);
+
+    /**
+     * Computes the number of blocks a payload is split into.
+     *
+     * @param payloadLength The length of the payload in bytes.
+     * @param blockSize The block size in bytes.
+     * @return The number of blocks.
+     */
+    static size_t getBlockCount(size_t payloadLength, size_t blockSize);
+
+    /**
+     * Builds frames firstIndex ... firstIndex + frameCount - 1 of the sequence of a payload.
+     * The first getBlockCount() frames carry the blocks themselves; any later frames mix several blocks.
+     *
+     * @param payload The payload, any bytes.
+     * @param blockSize The block size in bytes (1-65535).
+     * @param firstIndex Index of the first frame to build.
+     * @param frameCount Number of frames to build.
+     * @param options The encode options holding the error correction level and thread budget.
+     * @return The frames in index order.
+     * @throws EmptyInputMessageException if the payload is empty.
+     * @throws InvalidFountainDataException if the block size, payload length or block count is out of range.
+     * @throws TooLongMessageException if a frame does not fit in any version.
+     */
+    static std::vector<QrFountainFrame> encodeFrames(const std::string& payload, size_t blockSize, uint32_t firstIndex,
+                                                     size_t frameCount, const QrEncodeOptions& options);
+};
+
+/**
+ * Reassembles a payload from the frames of one sequence, received in any order.
+ */
+class QrFountainDecoder {
+public:
+    /**
+     * Creates a decoder which accepts the first sequence it receives a frame of.
+     */
+    QrFountainDecoder();
+
+    /**
+     * Adds a received frame.
+     *
+     * @param text The text read from the symbol.
+     * @return True if the frame was new; false if a frame with the same index was added before.
+     * @throws InvalidFountainDataException if the frame is malformed or belongs to another sequence.
+     */
+    bool addFrame(const std::string& text);
+
+    /**
+     * @return True if all blocks of the payload were decoded; false otherwise.
+     */
+    bool isComplete() const;
+
+    /**
+     * @return The number of blocks of the sequence, or 0 before the first frame.
+     */
+    size_t getBlockCount() const;
+
+    /**
+     * @return The number of blocks decoded so far.
+     */
+    size_t getDecodedBlockCount() const;
+
+    /**
+     * Returns the decoded payload.
+     *
+     * @return The payload.
+     * @throws InvalidFountainDataException if the payload is not complete or fails the CRC check.
+     */
+    std::string getPayload() const;
+
+private:
+    /**
+     * A received frame mixing blocks which are not decoded yet.
+     */
+    struct PendingFrame {
+        std::vector<uint8_t> data;          ///< XOR of the remaining blocks.
+        std::vector<uint32_t> blocks;       ///< The remaining blocks.
+    };
+
+    uint32_t payloadLength;                         ///< Payload length from the frame headers.
+    size_t blockSize;                               ///< Block size from the frame headers; 0 before the first frame.
+    uint32_t checksum;                              ///< Payload CRC-32 from the frame headers.
+    std::vector<uint64_t> degreeDistribution;       ///< Cumulative degree distribution of the sequence.
+
+    std::set<uint32_t> seenFrames;                  ///< Indices of the frames added so far.
+    std::vector<std::vector<uint8_t>> blocks;       ///< Content of the decoded blocks.
+    std::vector<bool> decoded;                      ///< Which blocks are decoded.
+    size_t decodedCount;                            ///< Number of decoded blocks.
+    std::vector<PendingFrame> pendingFrames;        ///< Frames still mixing several blocks.
+    std::vector<std::vector<size_t>> blockFrames;   ///< Pending frames mixing each block.
+
+    /**
+     * Stores a decoded block and peels it off all pending frames, decoding the blocks this uncovers.
+     */
+    void resolveBlock(uint32_t block, std::vector<uint8_t> data);
+};
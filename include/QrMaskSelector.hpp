@@ -0,0 +1,108 @@
+/*
+After the data is placed, one of eight mask patterns is XORed over the
+data modules to avoid shapes which confuse scanners: large blocks of one
+color, long runs and patterns resembling the finder patterns. Each
+masked symbol gets a penalty score and the mask with the lowest score
+wins. Function patterns are never masked, so the selection needs to know
+which modules are reserved for them.
+*/
+
+
+#pragma once
+
+#include <stdexcept>
+#include <climits>
+
+#include "QrModuleMatrix.hpp"
+#include "QrEncodeOptions.hpp"
+
+/**
+ * Exception thrown when a mask pattern outside of 0-7 is requested.
+ */
+class InvalidMaskException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidMaskException with a specific error message.
+     *
+     * @param message The error message describing the invalid mask.
+     */
+    explicit InvalidMaskException(const std::string& message);
+};
+
+/**
+ * Result of the mask selection.
+ */
+struct QrMaskSelection {
+    int mask;           ///< The selected mask pattern (0-7).
+    int penalty;        ///< Full penalty of the symbol masked with the selected mask, or -1 if it was not computed.
+    int penaltyDelta;   ///< Penalty above the exhaustive selection, or -1 if it was not measured.
+};
+
+/**
+ * Utility class for applying mask patterns and selecting the best one.
+ */
+class QrMaskSelector {
+public:
+    /// Number of mask patterns defined by the standard.
+    static const int MaskCount = 8;
+
+    /**
+     * Checks if the mask pattern inverts the module at the given position.
+     *
+     * @param mask The mask pattern (0-7).
+     * @param row The row of the module.
+     * @param col The column of the module.
+     * @return True if the module is inverted; false otherwise.
+     */
+    static bool isMasked(int mask, int row, int col);
+
+    /**
+     * Inverts every module selected by the mask pattern which is not reserved.
+     *
+     * @param matrix The symbol to mask.
+     * @param reserved Matrix of the same size whose dark modules mark function patterns.
+     * @param mask The mask pattern (0-7).
+     * @throws InvalidMaskException if the mask is outside of 0-7.
+     */
+    static void applyMask(QrModuleMatrix& matrix, const QrModuleMatrix& reserved, int mask);
+
+    /**
+     * Computes the ISO 18004 penalty score of a symbol.
+     *
+     * @param matrix The masked symbol.
+     * @return The sum of the four penalty rules.
+     */
+    static int getPenalty(const QrModuleMatrix& matrix);
+
+    /**
+     * Selects the mask pattern for a symbol according to the strategy in the options.
+     * The matrix itself is left unmasked. Symbols of versions at or above the parallel version threshold
+     * score their candidates on up to threadBudget threads, with the same result as a single thread.
+     * The Fixed and Fast strategies only compute the full penalty when measurePenaltyDelta is set.
+     *
+     * @param matrix The unmasked symbol.
+     * @param reserved Matrix of the same size whose dark modules mark function patterns.
+     * @param options The encode options holding the mask strategy.
+     * @return The selected mask and its penalty, if computed.
+     * @throws InvalidMaskException if the fixed mask is outside of 0-7.
+     */
+    static QrMaskSelection selectMask(const QrModuleMatrix& matrix, const QrModuleMatrix& reserved, const QrEncodeOptions& options);
+
+private:
+    /**
+     * Computes the penalty score on every stride-th row and column, scaled back to the whole symbol.
+     * Stops as soon as the score exceeds the bound and returns the partial score.
+     */
+    static int scorePenalty(const QrModuleMatrix& matrix, int stride, int bound);
+
+    /**
+     * Selects the mask with the lowest score computed with the given stride, dropping candidates above the best score.
+     * Candidates are scored on up to threadCount threads.
+     */
+    static int findBestMask(const QrModuleMatrix& matrix, const QrModuleMatrix& reserved, int stride, int threadCount, int& score);
+
+    /**
+     * Validates the mask number.
+     */
+    static void checkMask(int mask);
+};
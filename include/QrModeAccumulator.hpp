@@ -0,0 +1,138 @@
+/*
+Messages do not always arrive in one piece. Network payloads come in
+chunks and interactive editors change the text one keystroke at a time.
+Rescanning the whole message after every change is wasteful, so this
+code keeps the mode eligibility of the message seen so far and updates
+it only for the bytes that were appended or removed. Multi-byte UTF-8
+and Shift JIS sequences may be split across chunk boundaries.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+#include "QrModeSelector.hpp"
+#include "QrVersionSelector.hpp"
+
+/**
+ * Incremental QR mode classifier for data which is appended or truncated in chunks.
+ *
+ * The answers given by this class always match QrModeSelector::getQrMode and
+ * QrVersionSelector::getQrVersion called on the whole accumulated message.
+ */
+class QrModeAccumulator {
+public:
+    /**
+     * Appends a chunk of data to the accumulated message.
+     *
+     * @param chunk The bytes to append.
+     */
+    void append(const std::string& chunk);
+
+    /**
+     * Appends a chunk of data to the accumulated message.
+     *
+     * @param data Pointer to the bytes to append.
+     * @param length Number of bytes to append.
+     */
+    void append(const char* data, size_t length);
+
+    /**
+     * Removes bytes from the end of the accumulated message.
+     *
+     * @param count Number of bytes to remove. Removing more bytes than accumulated clears the message.
+     */
+    void pop(size_t count = 1);
+
+    /**
+     * Shortens the accumulated message to the given length.
+     *
+     * @param length The new length. Lengths not shorter than the current one leave the message unchanged.
+     */
+    void truncate(size_t length);
+
+    /**
+     * Removes all accumulated data.
+     */
+    void clear();
+
+    /**
+     * @return The accumulated message.
+     */
+    const std::string& data() const;
+
+    /**
+     * @return The number of accumulated bytes.
+     */
+    size_t length() const;
+
+    /**
+     * @return True if no data was accumulated; false otherwise.
+     */
+    bool empty() const;
+
+    /**
+     * @return True if the accumulated message is numeric; false otherwise.
+     */
+    bool isNumeric() const;
+
+    /**
+     * @return True if the accumulated message is alphanumeric; false otherwise.
+     */
+    bool isAlphanumeric() const;
+
+    /**
+     * @return True if the accumulated message is valid for byte mode; false otherwise.
+     */
+    bool isByte() const;
+
+    /**
+     * @return True if the accumulated message is valid for kanji mode; false otherwise.
+     */
+    bool isKanji() const;
+
+    /**
+     * Determines the QR encoding mode for the accumulated message.
+     *
+     * @return The appropriate QrMode for the accumulated message.
+     * @throws InvalidInputMessageException if the message does not match any QR mode.
+     * @throws EmptyInputMessageException if no data was accumulated.
+     */
+    QrMode getQrMode() const;
+
+    /**
+     * Determines the QR version for the accumulated message and given error correction level.
+     *
+     * @param level The error correction level
+     * @return The appropriate version represented as intiger
+     * @throws InvalidInputMessageException if the message does not match any QR mode.
+     * @throws EmptyInputMessageException if no data was accumulated.
+     * @throws TooLongMessageException if the message is too long to encode
+     */
+    int getQrVersion(QrErrorCorrectionLevel level) const;
+
+private:
+    // Per byte parser state flags, stored after each accumulated byte
+    static const unsigned char Utf8PendingMask = 0x03;   ///< Continuation bytes still expected
+    static const unsigned char Utf8Invalid = 0x04;       ///< Message is not valid UTF-8
+    static const unsigned char KanjiPending = 0x08;      ///< Second Shift JIS byte expected
+    static const unsigned char KanjiInvalid = 0x10;      ///< Message is not valid Shift JIS
+
+    /**
+     * Computes the parser state after consuming one more byte.
+     */
+    static unsigned char nextState(unsigned char state, unsigned char c);
+
+    /**
+     * @return The parser state after the last accumulated byte.
+     */
+    unsigned char currentState() const;
+
+    std::string buffer;
+    std::vector<unsigned char> states;
+    size_t nonNumericCount = 0;
+    size_t nonAlphanumericCount = 0;
+};
@@ -85,6 +85,30 @@ public:
      * @return True if the string is valid for kanji mode; false otherwise.
      */
     static bool isKanji(const std::string& str);
+
+    /**
+     * Checks if a single character is allowed in numeric mode.
+     *
+     * @param c The character to validate.
+     * @return True if the character is numeric; false otherwise.
+     */
+    static bool isNumericChar(unsigned char c);
+
+    /**
+     * Checks if a single character is allowed in alphanumeric mode.
+     *
+     * @param c The character to validate.
+     * @return True if the character is alphanumeric; false otherwise.
+     */
+    static bool isAlphanumericChar(unsigned char c);
+
+    /**
+     * Checks if a byte starts a two byte character in a string accepted by isKanji.
+     *
+     * @param c The byte to check.
+     * @return True if the byte is a Shift JIS lead byte; false if it is a character by itself.
+     */
+    static bool isKanjiLeadByte(unsigned char c);
 };
 
 /**
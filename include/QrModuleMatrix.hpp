@@ -0,0 +1,104 @@
+/*
+A QR symbol is a square grid of dark and light modules. A symbol of
+version V is 17 + 4 * V modules wide. This code stores the grid packed,
+one bit per module, with each row padded to whole 64 bit words, so rows
+can be copied, compared and converted to output formats a word at a time.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * Exception thrown when a QR version outside of 1-40 is requested.
+ */
+class InvalidVersionException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidVersionException with a specific error message.
+     *
+     * @param message The error message describing the invalid version.
+     */
+    explicit InvalidVersionException(const std::string& message);
+};
+
+/**
+ * Square matrix of QR modules packed one bit per module.
+ * Module (row, col) is bit (col % 64) of word (col / 64) of the row; a set bit is a dark module.
+ */
+class QrModuleMatrix {
+public:
+    /**
+     * Constructs a matrix of light modules.
+     *
+     * @param size Width and height of the matrix in modules.
+     */
+    explicit QrModuleMatrix(int size);
+
+    /**
+     * Constructs a matrix of light modules sized for the given version.
+     *
+     * @param version The QR version (1-40).
+     * @return The matrix of 17 + 4 * version modules.
+     * @throws InvalidVersionException if the version is outside of 1-40.
+     */
+    static QrModuleMatrix fromVersion(int version);
+
+    /**
+     * Returns the width of a symbol of the given version.
+     *
+     * @param version The QR version (1-40).
+     * @return The width in modules.
+     * @throws InvalidVersionException if the version is outside of 1-40.
+     */
+    static int sizeForVersion(int version);
+
+    /**
+     * @return Width and height of the matrix in modules.
+     */
+    int size() const;
+
+    /**
+     * @return Number of 64 bit words used by each row.
+     */
+    int wordsPerRow() const;
+
+    /**
+     * @param row The row of the module.
+     * @param col The column of the module.
+     * @return True if the module is dark; false otherwise.
+     */
+    bool get(int row, int col) const;
+
+    /**
+     * @param row The row of the module.
+     * @param col The column of the module.
+     * @param dark True to make the module dark; false to make it light.
+     */
+    void set(int row, int col, bool dark);
+
+    /**
+     * @param row The row to access.
+     * @return Pointer to the wordsPerRow() words of the row.
+     */
+    const uint64_t* rowData(int row) const;
+
+    /**
+     * @param row The row to access.
+     * @return Pointer to the wordsPerRow() words of the row.
+     */
+    uint64_t* rowData(int row);
+
+    bool operator==(const QrModuleMatrix& other) const;
+    bool operator!=(const QrModuleMatrix& other) const;
+
+private:
+    int matrixSize;
+    int rowWords;
+    std::vector<uint64_t> words;
+};
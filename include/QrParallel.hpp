@@ -0,0 +1,58 @@
+/*
+Large symbols contain independent pieces of work, such as the eight
+mask candidates. Running them on a few threads cuts the latency of a
+single encode, but handing work to other threads costs more than the
+whole encode of a small symbol. This code decides how many threads an encode may use,
+based on the symbol version, and runs independent tasks on them. The
+default version threshold suits a typical machine until
+QrBulkClassifier::calibrate measures the one of the running machine. The
+threads are kept in a pool for the lifetime of the process, so only the
+first parallel encodes pay for starting them. Tasks write their results
+by index, so the output does not depend on thread scheduling.
+*/
+
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "QrEncodeOptions.hpp"
+
+/**
+ * Utility class for running the independent parts of one encode in parallel.
+ */
+class QrParallel {
+public:
+    /**
+     * Determines how many threads an encode of the given version may use.
+     *
+     * @param version The version selected by QrVersionSelector::getQrVersion.
+     * @param options The encode options holding the thread budget and version threshold.
+     * @return 1 below the version threshold; the thread budget (at least 1) otherwise.
+     */
+    static int getThreadCount(int version, const QrEncodeOptions& options);
+
+    /**
+     * @return The version threshold used by options without their own; 30 until setVersionThreshold is called.
+     */
+    static int getVersionThreshold();
+
+    /**
+     * Sets the version threshold used by options without their own.
+     *
+     * @param version The smallest version for which the thread budget is used; 41 to never use it.
+     */
+    static void setVersionThreshold(int version);
+
+    /**
+     * Runs task(0) ... task(count - 1) on up to threadCount threads, including the calling one.
+     * The other threads come from a pool shared by all calls and kept until the process exits.
+     * Returns after all tasks finished. If tasks throw, the exception of the lowest task index is rethrown.
+     *
+     * @param count Number of tasks.
+     * @param threadCount Maximum number of threads; values below 2 run all tasks on the calling thread.
+     * @param task The task to run for every index.
+     */
+    static void forEach(size_t count, int threadCount, const std::function<void(size_t)>& task);
+};
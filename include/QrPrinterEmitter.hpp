@@ -0,0 +1,81 @@
+/*
+Label printers do not need an image file. Zebra printers accept ZPL,
+where a ^GF command carries a monochrome graphic as hex digits with a
+built-in run-length compression. Receipt and label printers speaking
+ESC/POS accept raster bit images through the GS v 0 command. This code
+writes both commands straight from a module matrix, pulling the scaled
+dot rows one at a time from QrRowRenderer.
+*/
+
+
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <stdexcept>
+
+#include "QrModuleMatrix.hpp"
+
+/**
+ * Exception thrown when the printer output parameters are invalid.
+ */
+class InvalidPrinterParametersException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidPrinterParametersException with a specific error message.
+     *
+     * @param message The error message describing the invalid parameters.
+     */
+    explicit InvalidPrinterParametersException(const std::string& message);
+};
+
+/**
+ * Utility class for writing module matrices as thermal printer commands.
+ * Dark modules are printed as black dots. Memory use depends only on the width of one dot row.
+ */
+class QrPrinterEmitter {
+public:
+    /// Largest number of dot rows sent in a single GS v 0 command.
+    static const int EscPosMaxBandRows = 256;
+
+    /**
+     * Writes the matrix as a ZPL ^GFA graphic field using ZPL ASCII hex compression.
+     * Only the ^GFA command is written, so it can be placed after a ^FO command of a label.
+     *
+     * @param matrix The modules to print.
+     * @param dotsPerModule Width and height of one module in printer dots.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @param out The stream receiving the command.
+     * @throws InvalidPrinterParametersException if dotsPerModule is not positive or quietZone is negative.
+     */
+    static void writeZpl(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone, std::ostream& out);
+
+    /**
+     * Writes the matrix as ESC/POS GS v 0 raster bit image commands.
+     * Images taller than EscPosMaxBandRows dots are split into several commands printed one below the other.
+     *
+     * @param matrix The modules to print.
+     * @param dotsPerModule Width and height of one module in printer dots.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @param out The stream receiving the commands.
+     * @throws InvalidPrinterParametersException if dotsPerModule is not positive, quietZone is negative
+     *         or a dot row is wider than the command allows.
+     */
+    static void writeEscPos(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone, std::ostream& out);
+
+private:
+    /**
+     * Writes one row of ZPL hex data using the ZPL compression scheme.
+     */
+    static void writeZplRow(const unsigned char* bytes, int length, std::ostream& out);
+
+    /**
+     * Writes a ZPL repeat count followed by the repeated hex digit.
+     */
+    static void writeZplRun(int count, char digit, std::ostream& out);
+
+    /**
+     * Validates the common printer parameters.
+     */
+    static void checkParameters(int dotsPerModule, int quietZone);
+};
@@ -0,0 +1,109 @@
+/*
+At printer resolutions a large symbol scaled to its final size takes
+tens of megabytes as a full image, but output devices consume it one
+dot row at a time. This code renders a module matrix row by row on
+request: the dot row is mapped to its module row, which is expanded
+horizontally into a packed scanline with the quiet zone on both sides.
+All dot rows of a module row share one expansion. Memory use is one
+scanline, independent of the scale, so image writers and printer
+emitters can stream symbols of any size.
+*/
+
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "QrModuleMatrix.hpp"
+
+/**
+ * Exception thrown when the rendering parameters are invalid.
+ */
+class InvalidRenderParametersException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidRenderParametersException with a specific error message.
+     *
+     * @param message The error message describing the invalid parameters.
+     */
+    explicit InvalidRenderParametersException(const std::string& message);
+};
+
+/**
+ * Pulls the packed dot rows of a scaled symbol one at a time, top to bottom.
+ * Rows are packed most significant bit first, 1 for a dark dot, and padded with light dots to whole bytes.
+ * The matrix must outlive the renderer.
+ */
+class QrRowRenderer {
+public:
+    /**
+     * Creates a renderer positioned before the first dot row.
+     *
+     * @param matrix The modules to render.
+     * @param dotsPerModule Width and height of one module in dots.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @throws InvalidRenderParametersException if dotsPerModule is not positive or quietZone is negative.
+     */
+    QrRowRenderer(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone);
+
+    /**
+     * Computes the width and height in dots of a rendered symbol of the given version.
+     *
+     * @param version The version selected by QrVersionSelector::getQrVersion.
+     * @param dotsPerModule Width and height of one module in dots.
+     * @param quietZone Width of the light border around the symbol in modules.
+     * @return The size in dots.
+     * @throws InvalidVersionException if the version is outside 1-40.
+     */
+    static int getDotSize(int version, int dotsPerModule, int quietZone);
+
+    /**
+     * @return The width and height of the rendered symbol in dots.
+     */
+    int size() const;
+
+    /**
+     * @return The number of bytes of a packed dot row.
+     */
+    int bytesPerRow() const;
+
+    /**
+     * @return The index of the row returned by the last nextRow call, or -1 before the first one.
+     */
+    int rowIndex() const;
+
+    /**
+     * Renders the next dot row.
+     *
+     * @return The packed row, valid until the next call; nullptr after the last row.
+     */
+    const unsigned char* nextRow();
+
+    /**
+     * @return True if the row returned by the last nextRow call is known to equal the one before it
+     *         (same module row, or both in the quiet zone); false otherwise.
+     */
+    bool repeatsPreviousRow() const;
+
+    /**
+     * Moves back before the first dot row.
+     */
+    void reset();
+
+private:
+    const QrModuleMatrix& matrix;
+    int dotsPerModule;
+    int quietZone;
+    int dots;
+    int currentRow;                     ///< Index of the last returned dot row.
+    int renderedModuleRow;              ///< Module row held in the scanline; -1 for a quiet row, -2 for none.
+    bool repeated;                      ///< Whether the last returned row repeats the one before.
+    std::vector<unsigned char> scanline;
+
+    /**
+     * Expands a module row into the scanline.
+     */
+    void renderModuleRow(int moduleRow);
+};
@@ -0,0 +1,119 @@
+/*
+Labels are often printed as sheets holding hundreds of symbols. Instead
+of producing an image per symbol and pasting them together, this code
+lays the symbols out on a grid of equally sized cells and renders each
+one directly into its place on the page. Grid rows cover disjoint parts
+of the page, so they are rendered by separate threads. The page is
+written either as a binary PBM raster or as a single page vector PDF,
+where every symbol is one path made of the dark runs of its rows.
+
+The cell size follows from the largest symbol on the sheet, which in turn
+follows from the versions selected for the payloads. A batch printed over
+several sheets can fix the cell size of the whole batch up front with
+getCellModules, so every sheet shares one grid.
+*/
+
+
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "QrModuleMatrix.hpp"
+#include "QrVersionSelector.hpp"
+
+/**
+ * Exception thrown when the sheet layout parameters are invalid.
+ */
+class InvalidSheetLayoutException : public std::invalid_argument {
+public:
+    /**
+     * Constructs an InvalidSheetLayoutException with a specific error message.
+     *
+     * @param message The error message describing the invalid layout.
+     */
+    explicit InvalidSheetLayoutException(const std::string& message);
+};
+
+/**
+ * Grid and scale of a sheet. All distances except the quiet zone are in dots.
+ */
+struct QrSheetLayout {
+    int columns = 10;           ///< Number of cells in a grid row.
+    int dotsPerModule = 4;      ///< Width and height of one module in dots.
+    int quietZone = 4;          ///< Light border around every symbol in modules.
+    int margin = 0;             ///< Light border around the page.
+    int gutter = 0;             ///< Space between neighbouring cells.
+    int dpi = 300;              ///< Resolution used to size the PDF page.
+    int cellModules = 0;        ///< Cell width in modules including the quiet zone, or 0 to fit the largest symbol.
+};
+
+/**
+ * Utility class for composing many symbols onto one page.
+ */
+class QrSheetComposer {
+public:
+    /**
+     * Computes the width of a symbol cell for a batch of payloads, in modules including the quiet zone.
+     * Payloads which cannot be encoded are ignored. The result is meant for QrSheetLayout::cellModules.
+     *
+     * @param payloads The payloads printed on the sheet.
+     * @param level The error correction level used for all payloads.
+     * @param quietZone Light border around every symbol in modules.
+     * @return The cell width in modules, or 0 if no payload can be encoded.
+     */
+    static int getCellModules(const std::vector<std::string>& payloads, QrErrorCorrectionLevel level, int quietZone);
+
+    /**
+     * Renders the symbols into a binary PBM (P4) page, one grid row per task.
+     * Symbols smaller than the cell are centred in it.
+     *
+     * @param symbols The symbols, placed row by row.
+     * @param layout The grid and scale of the sheet.
+     * @param threadCount Maximum number of threads rendering grid rows.
+     * @param out The stream receiving the page.
+     * @throws InvalidSheetLayoutException if the layout is invalid.
+     */
+    static void writePbm(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout, int threadCount, std::ostream& out);
+
+    /**
+     * Writes the symbols as a single page PDF with one filled path per symbol.
+     * The page uses the same geometry as writePbm, scaled to points by the layout dpi.
+     *
+     * @param symbols The symbols, placed row by row.
+     * @param layout The grid and scale of the sheet.
+     * @param threadCount Maximum number of threads building symbol paths.
+     * @param out The stream receiving the document.
+     * @throws InvalidSheetLayoutException if the layout is invalid.
+     */
+    static void writePdf(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout, int threadCount, std::ostream& out);
+
+private:
+    /**
+     * Page geometry derived from the layout and the largest symbol.
+     */
+    struct Geometry {
+        int cellModules;    ///< Cell width in modules.
+        int cellDots;       ///< Cell width in dots.
+        int gridRows;       ///< Number of grid rows.
+        int width;          ///< Page width in dots.
+        int height;         ///< Page height in dots.
+    };
+
+    /**
+     * Validates the layout and computes the page geometry.
+     */
+    static Geometry getGeometry(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout);
+
+    /**
+     * Returns the position of the top-left module of a symbol on the page, in dots.
+     */
+    static void getSymbolOrigin(size_t index, const QrModuleMatrix& symbol, const QrSheetLayout& layout, const Geometry& geometry, int& x, int& y);
+
+    /**
+     * Builds the PDF path of one symbol from the dark runs of its rows.
+     */
+    static std::string buildSymbolPath(const QrModuleMatrix& symbol, int x, int y, int dotsPerModule);
+};
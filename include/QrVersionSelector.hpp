@@ -12,6 +12,7 @@ In addition, the error correction level restricts the capacity further
 
 #include <string>
 #include <stdexcept>
+#include <cstddef>
 
 #include "QrModeSelector.hpp"
 
@@ -54,7 +55,36 @@ public:
      */
     static int getQrVersion(const std::string& input, QrErrorCorrectionLevel level, QrMode mode);
 
+    /**
+     * Determines the QR version for an already measured data length, error corection level and encoding mode.
+     *
+     * @param dataLength The length of the data, measured the same way as for the string overload.
+     * @param level The error correction level
+     * @param mode The encoding mode
+     * @return The appropriate version represented as intiger
+     * @throws TooLongMessageException if the data length is too long to encode
+     */
+    static int getQrVersion(size_t dataLength, QrErrorCorrectionLevel level, QrMode mode);
+
+    /**
+     * Returns the data capacity of a version for the given error correction level and encoding mode.
+     *
+     * @param version The version (1-40).
+     * @param level The error correction level
+     * @param mode The encoding mode
+     * @return The capacity, measured the same way as the input length in getQrVersion
+     * @throws InvalidVersionException if the version is outside of 1-40.
+     */
+    static int getDataCapacity(int version, QrErrorCorrectionLevel level, QrMode mode);
+
 private:
+    /**
+     * Finds the smallest version which fits the given data length.
+     *
+     * @return The version (1-40), or 0 if no version can contain the data.
+     */
+    static int findQrVersion(size_t dataLength, QrErrorCorrectionLevel level, QrMode mode);
+
     // Lookup table representing data capacities for each version, error correction level, and encoding mode
     static const int dataCapacities[40][4][4];
 
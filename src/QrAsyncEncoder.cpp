@@ -0,0 +1,198 @@
+#include "../include/QrAsyncEncoder.hpp"
+#include "../include/QrVersionSelector.hpp"
+
+/**
+ * Constructs a QrCancelledException with a specific error message.
+ *
+ * @param message The error message describing the cancelled request.
+ */
+QrCancelledException::QrCancelledException(const std::string& message)
+    : std::runtime_error(message) {}
+
+/**
+ * Creates a token which is not cancelled.
+ */
+QrCancellationToken::QrCancellationToken()
+    : cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+/**
+ * Cancels all requests holding this token which have not started yet.
+ */
+void QrCancellationToken::cancel() {
+    cancelled->store(true);
+}
+
+/**
+ * @return True if the token was cancelled; false otherwise.
+ */
+bool QrCancellationToken::isCancelled() const {
+    return cancelled->load();
+}
+
+/**
+ * Encodes a payload on the calling thread.
+ *
+ * @param payload The payload.
+ * @param options The encode options.
+ * @return The selected mode and version.
+ * @throws std::invalid_argument if the payload cannot be encoded.
+ */
+QrEncodeResult QrAsyncEncoder::encode(const std::string& payload, const QrEncodeOptions& options) {
+    QrEncodeResult result;
+    result.mode = QrModeSelector::getQrMode(payload);
+    result.version = QrVersionSelector::getQrVersion(payload, options.level, result.mode);
+    return result;
+}
+
+/**
+ * Checks if a payload is small enough to be encoded on the calling thread.
+ *
+ * @param payload The payload.
+ * @param options The encode options holding the inline length.
+ * @return True if the payload is encoded inline; false if it is handed to the executor.
+ */
+bool QrAsyncEncoder::runsInline(const std::string& payload, const QrEncodeOptions& options) {
+    return options.asyncInlineLength >= 0 && payload.length() <= static_cast<size_t>(options.asyncInlineLength);
+}
+
+/**
+ * Encodes a payload inline or on the executor and reports the outcome to the callback.
+ *
+ * @param payload The payload.
+ * @param options The encode options.
+ * @param executor Runs large requests; an empty executor runs every request inline.
+ * @param token Cancels the request if it has not started yet.
+ * @param callback Receives the result or the exception.
+ */
+void QrAsyncEncoder::encodeAsync(const std::string& payload, const QrEncodeOptions& options, const QrExecutor& executor,
+                                 const QrCancellationToken& token, const QrEncodeCallback& callback) {
+    if (!executor || runsInline(payload, options)) {
+        run(payload, options, token, callback);
+        return;
+    }
+    // The task owns copies of everything, the caller may return before it runs
+    executor([payload, options, token, callback]() {
+        run(payload, options, token, callback);
+    });
+}
+
+/**
+ * Encodes a payload inline or on the executor.
+ *
+ * @param payload The payload.
+ * @param options The encode options.
+ * @param executor Runs large requests; an empty executor runs every request inline.
+ * @param token Cancels the request if it has not started yet.
+ * @return A future holding the result or the exception.
+ */
+std::future<QrEncodeResult> QrAsyncEncoder::encodeAsync(const std::string& payload, const QrEncodeOptions& options,
+                                                        const QrExecutor& executor, const QrCancellationToken& token) {
+    std::shared_ptr<std::promise<QrEncodeResult>> promise = std::make_shared<std::promise<QrEncodeResult>>();
+    std::future<QrEncodeResult> future = promise->get_future();
+    encodeAsync(payload, options, executor, token, [promise](const QrEncodeResult& result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(result);
+        }
+    });
+    return future;
+}
+
+/**
+ * Encodes a batch of payloads, each inline or on the executor, and reports all outcomes at once.
+ * Every request writes its own slot of the shared results; the request which brings the pending
+ * count to zero reports the batch. If the executor throws while a payload is submitted, that payload
+ * and all later ones are not submitted and report its exception. Exceptions thrown by the callback
+ * reach the caller when the last payload runs on the calling thread.
+ *
+ * @param payloads The payloads.
+ * @param options The encode options used for all payloads.
+ * @param executor Runs large requests; an empty executor runs every request inline.
+ * @param token Cancels the requests which have not started yet.
+ * @param callback Receives the results and errors in payload order.
+ */
+void QrAsyncEncoder::encodeBatchAsync(const std::vector<std::string>& payloads, const QrEncodeOptions& options,
+                                      const QrExecutor& executor, const QrCancellationToken& token, const QrBatchCallback& callback) {
+    struct Batch {
+        std::vector<QrEncodeResult> results;
+        std::vector<std::exception_ptr> errors;
+        std::atomic<size_t> pending;
+        std::atomic<bool> reported;
+        QrBatchCallback callback;
+    };
+
+    if (payloads.empty()) {
+        callback(std::vector<QrEncodeResult>(), std::vector<std::exception_ptr>());
+        return;
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->results.resize(payloads.size());
+    batch->errors.resize(payloads.size());
+    batch->pending.store(payloads.size());
+    batch->reported.store(false);
+    batch->callback = callback;
+
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        QrEncodeCallback finish = [batch, i](const QrEncodeResult& result, std::exception_ptr error) {
+            batch->results[i] = result;
+            batch->errors[i] = error;
+            if (--batch->pending == 0) {
+                batch->reported.store(true);
+                batch->callback(batch->results, batch->errors);
+            }
+        };
+        if (!executor || runsInline(payloads[i], options)) {
+            // Exceptions thrown here come from the batch callback and reach the caller
+            run(payloads[i], options, token, finish);
+            continue;
+        }
+
+        const std::string& payload = payloads[i];
+        try {
+            executor([payload, options, token, finish]() {
+                run(payload, options, token, finish);
+            });
+        } catch (...) {
+            if (batch->reported.load()) {
+                // The executor ran the last task at once and the batch callback threw
+                throw;
+            }
+            // The executor refused the task, so this and the remaining payloads fail with its exception
+            std::exception_ptr error = std::current_exception();
+            size_t unsubmitted = payloads.size() - i;
+            for (size_t j = i; j < payloads.size(); ++j) {
+                batch->errors[j] = error;
+            }
+            if (batch->pending.fetch_sub(unsubmitted) == unsubmitted) {
+                batch->reported.store(true);
+                batch->callback(batch->results, batch->errors);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Encodes a payload unless the token was cancelled and reports the outcome to the callback.
+ *
+ * @param payload The payload.
+ * @param options The encode options.
+ * @param token Checked before the payload is encoded.
+ * @param callback Receives the result or the exception.
+ */
+void QrAsyncEncoder::run(const std::string& payload, const QrEncodeOptions& options, const QrCancellationToken& token,
+                         const QrEncodeCallback& callback) {
+    QrEncodeResult result = {QrMode::ByteMode, 0};
+    std::exception_ptr error;
+    try {
+        if (token.isCancelled()) {
+            throw QrCancelledException("Encode request was cancelled");
+        }
+        result = encode(payload, options);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    callback(result, error);
+}
@@ -0,0 +1,365 @@
+#include "../include/QrBitSlicedBatch.hpp"
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+
+const size_t QrBitSlicedBatch::LaneCount;
+const int QrBitSlicedBatch::CounterBits;
+
+/**
+ * Groups payloads by the version selected by QrVersionSelector.
+ *
+ * @param payloads The payloads to group.
+ * @param level The error correction level used for all payloads.
+ * @return The grouping, with groups ordered by version and lanes in batch order.
+ */
+QrBatchPlan QrBitSlicedBatch::group(const std::vector<std::string>& payloads, QrErrorCorrectionLevel level) {
+    QrBatchPlan plan;
+
+    // Version -> indices of its groups in plan.groups, the last one being the one filled
+    std::map<int, std::vector<size_t> > groupsByVersion;
+    std::vector<size_t> order;
+
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        QrMode mode;
+        int version;
+        try {
+            mode = QrModeSelector::getQrMode(payloads[i]);
+            version = QrVersionSelector::getQrVersion(payloads[i].length(), level, mode);
+        } catch (const std::invalid_argument&) {
+            plan.rejected.push_back(i);
+            continue;
+        }
+
+        std::vector<size_t>& versionGroups = groupsByVersion[version];
+        if (versionGroups.empty() || plan.groups[versionGroups.back()].indices.size() == LaneCount) {
+            QrBatchGroup batchGroup;
+            batchGroup.level = level;
+            batchGroup.version = version;
+            versionGroups.push_back(plan.groups.size());
+            plan.groups.push_back(batchGroup);
+        }
+
+        QrBatchGroup& batchGroup = plan.groups[versionGroups.back()];
+        batchGroup.indices.push_back(i);
+        batchGroup.modes.push_back(mode);
+    }
+
+    // Order groups by version, keeping groups of the same version in batch order
+    std::vector<QrBatchGroup> ordered;
+    ordered.reserve(plan.groups.size());
+    for (std::map<int, std::vector<size_t> >::const_iterator it = groupsByVersion.begin(); it != groupsByVersion.end(); ++it) {
+        for (size_t groupIndex : it->second) {
+            ordered.push_back(plan.groups[groupIndex]);
+        }
+    }
+    plan.groups.swap(ordered);
+
+    return plan;
+}
+
+/**
+ * Converts up to LaneCount byte strings to bit-sliced form, 64 bit planes at a time.
+ *
+ * @param lanes The byte strings, one per lane.
+ * @return The bit planes.
+ * @throws std::invalid_argument if more than LaneCount lanes are given.
+ */
+std::vector<uint64_t> QrBitSlicedBatch::transpose(const std::vector<std::string>& lanes) {
+    if (lanes.size() > LaneCount) {
+        throw std::invalid_argument("Bit-sliced batch cannot hold more than 64 lanes");
+    }
+
+    size_t maxLength = 0;
+    for (const std::string& lane : lanes) {
+        maxLength = std::max(maxLength, lane.size());
+    }
+
+    // Each block covers 8 bytes of every lane, which is 64 bit planes
+    size_t blockCount = (maxLength + 7) / 8;
+    std::vector<uint64_t> planes(blockCount * 64, 0);
+
+    for (size_t block = 0; block < blockCount; ++block) {
+        uint64_t* rows = &planes[block * 64];
+        for (size_t lane = 0; lane < lanes.size(); ++lane) {
+            uint64_t row = 0;
+            for (size_t k = 0; k < 8 && block * 8 + k < lanes[lane].size(); ++k) {
+                row |= static_cast<uint64_t>(static_cast<unsigned char>(lanes[lane][block * 8 + k])) << (k * 8);
+            }
+            // Bytes are packed whole; the most significant bit of each byte goes first
+            rows[lane] = reverseByteBits(row);
+        }
+        transpose64(rows);
+    }
+
+    return planes;
+}
+
+/**
+ * Converts bit-sliced data back to byte strings.
+ *
+ * @param planes The bit planes produced by transpose.
+ * @param lengths The length in bytes of each lane to extract.
+ * @return The byte strings, one per entry in lengths.
+ * @throws std::invalid_argument if more than LaneCount lanes are requested or planes are too short.
+ */
+std::vector<std::string> QrBitSlicedBatch::untranspose(const std::vector<uint64_t>& planes, const std::vector<size_t>& lengths) {
+    if (lengths.size() > LaneCount) {
+        throw std::invalid_argument("Bit-sliced batch cannot hold more than 64 lanes");
+    }
+
+    size_t maxLength = 0;
+    for (size_t length : lengths) {
+        maxLength = std::max(maxLength, length);
+    }
+    if (planes.size() % 64 != 0 || planes.size() / 8 < maxLength) {
+        throw std::invalid_argument("Bit planes do not cover the requested lane lengths");
+    }
+
+    std::vector<std::string> lanes(lengths.size());
+    for (size_t lane = 0; lane < lengths.size(); ++lane) {
+        lanes[lane].reserve(lengths[lane]);
+    }
+
+    uint64_t rows[64];
+    for (size_t block = 0; block * 8 < maxLength; ++block) {
+        std::copy(planes.begin() + block * 64, planes.begin() + block * 64 + 64, rows);
+        transpose64(rows);
+        for (size_t lane = 0; lane < lengths.size(); ++lane) {
+            uint64_t row = reverseByteBits(rows[lane]);
+            for (size_t k = 0; k < 8 && block * 8 + k < lengths[lane]; ++k) {
+                lanes[lane].push_back(static_cast<char>(row >> (k * 8)));
+            }
+        }
+    }
+
+    return lanes;
+}
+
+/**
+ * Computes the penalty scores of up to LaneCount masked symbols of the same size at once.
+ *
+ * @param symbols The masked symbols.
+ * @return The score of each symbol, equal to QrMaskSelector::getPenalty.
+ * @throws std::invalid_argument if more than LaneCount symbols are given or their sizes differ.
+ */
+std::vector<int> QrBitSlicedBatch::getPenalties(const std::vector<QrModuleMatrix>& symbols) {
+    int size = checkSymbols(symbols);
+    if (symbols.empty()) {
+        return std::vector<int>();
+    }
+    return scorePlanes(sliceSymbols(symbols, size), size, symbols.size());
+}
+
+/**
+ * Selects the mask of up to LaneCount symbols of the same size at once.
+ * The symbols are sliced once; each mask then flips the words of the positions it inverts in every lane.
+ * Ties are resolved towards the lower mask number, as in QrMaskSelector.
+ *
+ * @param symbols The unmasked symbols.
+ * @param reserved Matrix of the same size whose dark modules mark function patterns.
+ * @return The selected mask and its penalty for each symbol; the penalty delta is not measured.
+ * @throws std::invalid_argument if more than LaneCount symbols are given or their sizes differ.
+ */
+std::vector<QrMaskSelection> QrBitSlicedBatch::selectMasks(const std::vector<QrModuleMatrix>& symbols, const QrModuleMatrix& reserved) {
+    int size = checkSymbols(symbols);
+    if (symbols.empty()) {
+        return std::vector<QrMaskSelection>();
+    }
+    if (reserved.size() != size) {
+        throw std::invalid_argument("Reserved modules do not match the size of the bit-sliced symbols");
+    }
+
+    std::vector<uint64_t> planes = sliceSymbols(symbols, size);
+    std::vector<uint64_t> masked(planes.size());
+    std::vector<QrMaskSelection> selections(symbols.size());
+    for (int mask = 0; mask < QrMaskSelector::MaskCount; ++mask) {
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                size_t position = static_cast<size_t>(row) * size + col;
+                bool inverted = QrMaskSelector::isMasked(mask, row, col) && !reserved.get(row, col);
+                masked[position] = inverted ? ~planes[position] : planes[position];
+            }
+        }
+
+        std::vector<int> penalties = scorePlanes(masked, size, symbols.size());
+        for (size_t lane = 0; lane < symbols.size(); ++lane) {
+            if (mask == 0 || penalties[lane] < selections[lane].penalty) {
+                selections[lane].mask = mask;
+                selections[lane].penalty = penalties[lane];
+                selections[lane].penaltyDelta = -1;
+            }
+        }
+    }
+
+    return selections;
+}
+
+/**
+ * Converts symbols to one word per module position, 64 columns of a row at a time.
+ * Word w of a row of every lane forms one 64x64 block, which transposes into the words of columns 64w to 64w+63.
+ *
+ * @param symbols The symbols, one per lane.
+ * @param size The common size of the symbols.
+ * @return The words, row by row; bits of missing lanes are zero.
+ */
+std::vector<uint64_t> QrBitSlicedBatch::sliceSymbols(const std::vector<QrModuleMatrix>& symbols, int size) {
+    std::vector<uint64_t> planes(static_cast<size_t>(size) * size);
+    uint64_t block[64];
+    for (int row = 0; row < size; ++row) {
+        for (int word = 0; word * 64 < size; ++word) {
+            for (size_t lane = 0; lane < LaneCount; ++lane) {
+                block[lane] = lane < symbols.size() ? symbols[lane].rowData(row)[word] : 0;
+            }
+            transpose64(block);
+            int columns = std::min(64, size - word * 64);
+            std::copy(block, block + columns, planes.begin() + static_cast<size_t>(row) * size + word * 64);
+        }
+    }
+    return planes;
+}
+
+/**
+ * Computes the penalty scores of all lanes of bit-sliced symbols.
+ * The line and block rules are summed in bit-sliced counters; the balance rule needs a division,
+ * so only the dark modules are counted that way and the rule is applied per lane.
+ *
+ * @param planes The bit-sliced symbols, as produced by sliceSymbols.
+ * @param size The size of the symbols.
+ * @param laneCount The number of lanes to score.
+ * @return The score of each lane.
+ */
+std::vector<int> QrBitSlicedBatch::scorePlanes(const std::vector<uint64_t>& planes, int size, size_t laneCount) {
+    uint64_t counter[CounterBits] = {};
+    uint64_t darkCounter[CounterBits] = {};
+
+    for (int row = 0; row < size; ++row) {
+        // The row and the column of the same index
+        const uint64_t* line = &planes[static_cast<size_t>(row) * size];
+        scoreLine(line, 1, size, counter);
+        scoreLine(&planes[row], size, size, counter);
+
+        for (int col = 0; col < size; ++col) {
+            addToCounter(darkCounter, line[col], 0);
+        }
+
+        // N2: 2x2 blocks of one color score 3
+        if (row + 1 < size) {
+            const uint64_t* next = line + size;
+            for (int col = 0; col + 1 < size; ++col) {
+                uint64_t block = ~(line[col] ^ line[col + 1]) & ~(line[col] ^ next[col]) & ~(line[col] ^ next[col + 1]);
+                addToCounter(counter, block, 0);
+                addToCounter(counter, block, 1);
+            }
+        }
+    }
+
+    long total = static_cast<long>(size) * size;
+    std::vector<int> penalties(laneCount);
+    for (size_t lane = 0; lane < laneCount; ++lane) {
+        long score = 0;
+        long dark = 0;
+        for (int bit = 0; bit < CounterBits; ++bit) {
+            score |= static_cast<long>((counter[bit] >> lane) & 1) << bit;
+            dark |= static_cast<long>((darkCounter[bit] >> lane) & 1) << bit;
+        }
+        // N4: 10 points for every full 5% away from an even split
+        penalties[lane] = static_cast<int>(score + std::labs(dark * 100 - total * 50) / (total * 5) * 10);
+    }
+    return penalties;
+}
+
+/**
+ * Adds the run (N1) and finder-like pattern (N3) scores of one bit-sliced line to the counters.
+ * A run of L >= 5 modules covers L - 4 windows of five modules of one color, and scoring its first
+ * window twice more gives the 3 + (L - 5) points of the rule.
+ *
+ * @param line The word of the first module of the line.
+ * @param step Distance between the words of neighbouring modules.
+ * @param size Number of modules in the line.
+ * @param counter The bit-sliced counters.
+ */
+void QrBitSlicedBatch::scoreLine(const uint64_t* line, size_t step, int size, uint64_t* counter) {
+    for (int i = 4; i < size; ++i) {
+        const uint64_t* m = line + (i - 4) * step;
+        uint64_t uniform = ~(m[0] ^ m[step]) & ~(m[step] ^ m[2 * step]) & ~(m[2 * step] ^ m[3 * step]) &
+                           ~(m[3 * step] ^ m[4 * step]);
+        addToCounter(counter, uniform, 0);
+        addToCounter(counter, i == 4 ? uniform : uniform & (m[0] ^ *(m - step)), 1);
+
+        // N3: dark-light-dark-dark-dark-light-dark with four light modules after or before it scores 40
+        if (i >= 10) {
+            const uint64_t* w = line + (i - 10) * step;
+            uint64_t finderFirst = w[0] & ~w[step] & w[2 * step] & w[3 * step] & w[4 * step] & ~w[5 * step] & w[6 * step];
+            uint64_t lightLast = ~(w[7 * step] | w[8 * step] | w[9 * step] | w[10 * step]);
+            uint64_t lightFirst = ~(w[0] | w[step] | w[2 * step] | w[3 * step]);
+            uint64_t finderLast = w[4 * step] & ~w[5 * step] & w[6 * step] & w[7 * step] & w[8 * step] & ~w[9 * step] & w[10 * step];
+            uint64_t pattern = (finderFirst & lightLast) | (lightFirst & finderLast);
+            addToCounter(counter, pattern, 3);
+            addToCounter(counter, pattern, 5);
+        }
+    }
+}
+
+/**
+ * Adds one bit per lane to bit-sliced counters, rippling the carries up.
+ *
+ * @param counter The counters, bit i of every lane in word i.
+ * @param bits The lanes to add to.
+ * @param weightBit The power of two added to each of these lanes.
+ */
+void QrBitSlicedBatch::addToCounter(uint64_t* counter, uint64_t bits, int weightBit) {
+    for (int bit = weightBit; bits != 0 && bit < CounterBits; ++bit) {
+        uint64_t carry = counter[bit] & bits;
+        counter[bit] ^= bits;
+        bits = carry;
+    }
+}
+
+/**
+ * Validates the lane count and sizes of a group of symbols.
+ *
+ * @param symbols The symbols.
+ * @return The common size of the symbols, or 0 if there are none.
+ * @throws std::invalid_argument if more than LaneCount symbols are given or their sizes differ.
+ */
+int QrBitSlicedBatch::checkSymbols(const std::vector<QrModuleMatrix>& symbols) {
+    if (symbols.size() > LaneCount) {
+        throw std::invalid_argument("Bit-sliced batch cannot hold more than 64 lanes");
+    }
+    int size = symbols.empty() ? 0 : symbols.front().size();
+    for (const QrModuleMatrix& symbol : symbols) {
+        if (symbol.size() != size) {
+            throw std::invalid_argument("Bit-sliced symbols must all have the same size");
+        }
+    }
+    return size;
+}
+
+/**
+ * Reverses the order of the bits within every byte of a word by swapping ever larger bit groups.
+ *
+ * @param word The word.
+ * @return The word with the bits of each byte reversed.
+ */
+uint64_t QrBitSlicedBatch::reverseByteBits(uint64_t word) {
+    word = ((word >> 1) & 0x5555555555555555ULL) | ((word & 0x5555555555555555ULL) << 1);
+    word = ((word >> 2) & 0x3333333333333333ULL) | ((word & 0x3333333333333333ULL) << 2);
+    return ((word >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((word & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+/**
+ * Transposes a 64x64 bit matrix in place by swapping ever smaller off-diagonal blocks.
+ *
+ * @param block The 64 words of the matrix, bit c of word r being element (r, c).
+ */
+void QrBitSlicedBatch::transpose64(uint64_t* block) {
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for (int width = 32; width != 0; width >>= 1, mask ^= mask << width) {
+        for (int k = 0; k < 64; k = ((k | width) + 1) & ~width) {
+            uint64_t t = ((block[k] >> width) ^ block[k | width]) & mask;
+            block[k | width] ^= t;
+            block[k] ^= t << width;
+        }
+    }
+}
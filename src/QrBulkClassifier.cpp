@@ -0,0 +1,714 @@
+#include "../include/QrBulkClassifier.hpp"
+#include "../include/QrMaskSelector.hpp"
+#include "../include/QrParallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifdef CPP_QR_CPU_VARIANTS
+#include <immintrin.h>
+#endif
+
+/**
+ * Constructs an InvalidColumnException with a specific error message.
+ *
+ * @param message The error message describing the invalid offsets.
+ */
+InvalidColumnException::InvalidColumnException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+namespace {
+
+const uint64_t ByteOnes = 0x0101010101010101ULL;
+const uint64_t ByteHighBits = 0x8080808080808080ULL;
+
+/// Byte classes, combined with AND over all bytes of a row.
+const uint8_t NumericClass = 0x01;
+const uint8_t AlphanumericClass = 0x02;
+const uint8_t AsciiClass = 0x04;
+
+/**
+ * Table of the classes of every byte value, built from the per character validators.
+ */
+struct ByteClassTable {
+    uint8_t classes[256];
+
+    ByteClassTable() {
+        for (int c = 0; c < 256; ++c) {
+            classes[c] = 0;
+            if (QrModeValidator::isNumericChar(static_cast<unsigned char>(c))) {
+                classes[c] |= NumericClass;
+            }
+            if (QrModeValidator::isAlphanumericChar(static_cast<unsigned char>(c))) {
+                classes[c] |= AlphanumericClass;
+            }
+            if (c < 0x80) {
+                classes[c] |= AsciiClass;
+            }
+        }
+    }
+};
+
+/**
+ * The capacity table reordered so that the 40 capacities of one level and mode are contiguous.
+ * Each column is padded with capacities no row exceeds, so vector kernels read whole registers.
+ */
+struct CapacityColumns {
+    static const int PaddedLength = 48;
+
+    int capacities[4][4][PaddedLength];
+
+    CapacityColumns() {
+        for (int level = 0; level < 4; ++level) {
+            for (int mode = 0; mode < 4; ++mode) {
+                for (int version = 1; version <= PaddedLength; ++version) {
+                    capacities[level][mode][version - 1] = version > 40 ? std::numeric_limits<int>::max() :
+                        QrVersionSelector::getDataCapacity(version, static_cast<QrErrorCorrectionLevel>(level), static_cast<QrMode>(mode));
+                }
+            }
+        }
+    }
+};
+
+const ByteClassTable& getByteClasses() {
+    static const ByteClassTable table;
+    return table;
+}
+
+const CapacityColumns& getCapacityColumns() {
+    static const CapacityColumns columns;
+    return columns;
+}
+
+/**
+ * Returns a non-zero value if any of the eight bytes of the word is not an ASCII digit.
+ * Bytes below 0x80 are tested against both ends of '0'-'9' without carries between bytes.
+ */
+CPP_QR_FORCE_INLINE uint64_t findNonDigit(uint64_t word) {
+    uint64_t aboveNine = word + (0x7F - '9') * ByteOnes;
+    uint64_t belowZero = (0x80 + '0' - 1) * ByteOnes - (word & ~ByteHighBits);
+    return (word | aboveNine | belowZero) & ByteHighBits;
+}
+
+/**
+ * Classifies a row with bytes above 0x7F with the full UTF-8 and Shift JIS validators.
+ * Such rows are rare in catalogs, so the copy into a string does not matter.
+ */
+bool classifyNonAscii(const char* row, size_t length, QrMode& mode) {
+    std::string text(row, length);
+    if (QrModeValidator::isByte(text)) {
+        mode = QrMode::ByteMode;
+    } else if (QrModeValidator::isKanji(text)) {
+        mode = QrMode::KanjiMode;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Picks the mode of a row from the classes shared by all of its bytes.
+ *
+ * @param numeric True if every byte is a digit.
+ * @param alphanumeric True if every byte is an alphanumeric character.
+ * @param ascii True if every byte is below 0x80.
+ * @param row The first byte of the row.
+ * @param length The length of the row in bytes.
+ * @param mode Receives the mode.
+ * @return True if the row can be encoded in some mode; false if it is invalid.
+ */
+CPP_QR_FORCE_INLINE bool selectMode(bool numeric, bool alphanumeric, bool ascii, const char* row, size_t length, QrMode& mode) {
+    if (numeric) {
+        mode = QrMode::NumericMode;
+    } else if (alphanumeric) {
+        mode = QrMode::AlphanumericMode;
+    } else if (ascii) {
+        mode = QrMode::ByteMode;
+    } else {
+        return classifyNonAscii(row, length, mode);
+    }
+    return true;
+}
+
+/**
+ * Classifies the mode of one row the same way as QrModeSelector::getQrMode.
+ * Leading digits are skipped eight at a time; the rest of the row is classified through the byte class table.
+ *
+ * @param row The first byte of the row.
+ * @param length The length of the row in bytes, at least 1.
+ * @param end The end of the column, which the generic kernel does not read past anyway.
+ * @param mode Receives the mode.
+ * @return True if the row can be encoded in some mode; false if it is invalid.
+ */
+CPP_QR_FORCE_INLINE bool classifyModeGeneric(const char* row, size_t length, const char* end, QrMode& mode) {
+    (void)end;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, row + i, sizeof(word));
+        if (findNonDigit(word) != 0) {
+            break;
+        }
+    }
+
+    const uint8_t* classes = getByteClasses().classes;
+    uint8_t rowClass = NumericClass | AlphanumericClass | AsciiClass;
+    for (; i < length; ++i) {
+        rowClass &= classes[static_cast<unsigned char>(row[i])];
+    }
+    return selectMode((rowClass & NumericClass) != 0, (rowClass & AlphanumericClass) != 0, (rowClass & AsciiClass) != 0,
+                      row, length, mode);
+}
+
+/**
+ * Finds the version of a row by counting the capacities of its level and mode which are smaller than its length.
+ *
+ * @param length The length of the row in bytes.
+ * @param capacities The padded capacity column of the level and mode of the row.
+ * @return The version, or 0 if the row does not fit in any version.
+ */
+CPP_QR_FORCE_INLINE int findVersionGeneric(size_t length, const int* capacities) {
+    int smaller = 0;
+    for (int i = 0; i < 40; ++i) {
+        smaller += static_cast<size_t>(capacities[i]) < length;
+    }
+    return smaller < 40 ? smaller + 1 : 0;
+}
+
+typedef bool (*ModeClassifier)(const char*, size_t, const char*, QrMode&);
+typedef int (*VersionFinder)(size_t, const int*);
+
+/**
+ * Classifies the rows [first, last) of a column with the mode and version functions of one level.
+ * Inlined into every level's kernel, so the calls to that level's functions are direct.
+ */
+CPP_QR_FORCE_INLINE void classifyRows(ModeClassifier classifyMode, VersionFinder findVersion, const int32_t* offsets,
+                                      const char* bytes, const char* end, size_t first, size_t last,
+                                      QrErrorCorrectionLevel level, QrBulkClassification* results) {
+    const int (*capacities)[CapacityColumns::PaddedLength] = getCapacityColumns().capacities[static_cast<int>(level)];
+    for (size_t row = first; row < last; ++row) {
+        size_t length = static_cast<size_t>(offsets[row + 1] - offsets[row]);
+        QrBulkClassification& result = results[row];
+        if (length > 0 && classifyMode(bytes + offsets[row], length, end, result.mode)) {
+            result.version = findVersion(length, capacities[static_cast<int>(result.mode)]);
+        } else {
+            result.mode = QrMode::ByteMode;
+            result.version = 0;
+        }
+    }
+}
+
+typedef void (*RowKernel)(const int32_t*, const char*, const char*, size_t, size_t, QrErrorCorrectionLevel, QrBulkClassification*);
+
+bool classifyModeScalar(const char* row, size_t length, const char* end, QrMode& mode) {
+    return classifyModeGeneric(row, length, end, mode);
+}
+
+int findVersionScalar(size_t length, const int* capacities) {
+    return findVersionGeneric(length, capacities);
+}
+
+void classifyRowsGeneric(const int32_t* offsets, const char* bytes, const char* end, size_t first, size_t last,
+                         QrErrorCorrectionLevel level, QrBulkClassification* results) {
+    classifyRows(classifyModeScalar, findVersionScalar, offsets, bytes, end, first, last, level, results);
+}
+
+#ifdef CPP_QR_CPU_VARIANTS
+
+/*
+The vector kernels classify up to a register of bytes of one row at once.
+The classes of a byte are the AND of a table entry for its high nibble and
+one for its low nibble, both looked up with a byte shuffle: bit 0 marks
+digits, bits 1-4 the alphanumeric characters with high nibble 2-5, bit 6
+the white space ones with high nibble 0 and bit 5 ASCII. Bytes above 0x7F
+have no bits, since their high nibble entries are 0.
+*/
+
+const uint8_t DigitBits = 0x01;
+const uint8_t AlphanumericBits = 0x5E;
+const uint8_t AsciiBits = 0x20;
+
+alignas(16) const uint8_t HighNibbleClasses[16] = {
+    0x60, 0x20, 0x22, 0x25, 0x28, 0x30, 0x20, 0x20, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+alignas(16) const uint8_t LowNibbleClasses[16] = {
+    0x37, 0x3D, 0x3D, 0x3D, 0x3F, 0x3F, 0x3D, 0x3D, 0x3D, 0x7D, 0x7E, 0x6A, 0x68, 0x6A, 0x2A, 0x2A
+};
+
+/**
+ * Returns the bits of the first count lanes of a 32 lane mask.
+ */
+CPP_QR_FORCE_INLINE uint32_t getLaneMask32(size_t count) {
+    return count >= 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_SSE42)
+bool classifyModeSse42(const char* row, size_t length, const char* end, QrMode& mode) {
+    const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(HighNibbleClasses));
+    const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(LowNibbleClasses));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t nonDigit = 0;
+    uint32_t nonAlphanumeric = 0;
+    uint32_t nonAscii = 0;
+    for (size_t i = 0; i < length; i += 16) {
+        __m128i chunk;
+        if (end - (row + i) >= 16) {
+            chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        } else {
+            // The last bytes of the column; the lanes past the row are masked below
+            char tail[16] = {};
+            std::memcpy(tail, row + i, std::min<size_t>(16, length - i));
+            chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+        }
+        __m128i classes = _mm_and_si128(_mm_shuffle_epi8(low, _mm_and_si128(chunk, nibble)),
+                                        _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(chunk, 4), nibble)));
+        uint32_t valid = getLaneMask32(length - i) & 0xFFFF;
+        nonDigit |= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(classes, _mm_set1_epi8(DigitBits)), zero)) & valid;
+        nonAlphanumeric |= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(classes, _mm_set1_epi8(AlphanumericBits)), zero)) & valid;
+        nonAscii |= _mm_movemask_epi8(chunk) & valid;
+    }
+    return selectMode(nonDigit == 0, nonAlphanumeric == 0, nonAscii == 0, row, length, mode);
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_SSE42)
+int findVersionSse42(size_t length, const int* capacities) {
+    __m128i rowLength = _mm_set1_epi32(static_cast<int>(length));
+    __m128i smaller = _mm_setzero_si128();
+    for (int i = 0; i < 40; i += 4) {
+        // Lanes of smaller capacities are -1, so subtracting them counts them
+        __m128i column = _mm_loadu_si128(reinterpret_cast<const __m128i*>(capacities + i));
+        smaller = _mm_sub_epi32(smaller, _mm_cmpgt_epi32(rowLength, column));
+    }
+    smaller = _mm_add_epi32(smaller, _mm_shuffle_epi32(smaller, 0x4E));
+    smaller = _mm_add_epi32(smaller, _mm_shuffle_epi32(smaller, 0xB1));
+    int count = _mm_cvtsi128_si32(smaller);
+    return count < 40 ? count + 1 : 0;
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_SSE42)
+void classifyRowsSse42(const int32_t* offsets, const char* bytes, const char* end, size_t first, size_t last,
+                       QrErrorCorrectionLevel level, QrBulkClassification* results) {
+    classifyRows(classifyModeSse42, findVersionSse42, offsets, bytes, end, first, last, level, results);
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX2)
+bool classifyModeAvx2(const char* row, size_t length, const char* end, QrMode& mode) {
+    const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(HighNibbleClasses)));
+    const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(LowNibbleClasses)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t nonDigit = 0;
+    uint32_t nonAlphanumeric = 0;
+    uint32_t nonAscii = 0;
+    for (size_t i = 0; i < length; i += 32) {
+        __m256i chunk;
+        if (end - (row + i) >= 32) {
+            chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        } else {
+            // The last bytes of the column; the lanes past the row are masked below
+            char tail[32] = {};
+            std::memcpy(tail, row + i, std::min<size_t>(32, length - i));
+            chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tail));
+        }
+        __m256i classes = _mm256_and_si256(_mm256_shuffle_epi8(low, _mm256_and_si256(chunk, nibble)),
+                                           _mm256_shuffle_epi8(high, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble)));
+        uint32_t valid = getLaneMask32(length - i);
+        nonDigit |= static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_and_si256(classes, _mm256_set1_epi8(DigitBits)), zero))) & valid;
+        nonAlphanumeric |= static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_and_si256(classes, _mm256_set1_epi8(AlphanumericBits)), zero))) & valid;
+        nonAscii |= static_cast<uint32_t>(_mm256_movemask_epi8(chunk)) & valid;
+    }
+    return selectMode(nonDigit == 0, nonAlphanumeric == 0, nonAscii == 0, row, length, mode);
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX2)
+int findVersionAvx2(size_t length, const int* capacities) {
+    __m256i rowLength = _mm256_set1_epi32(static_cast<int>(length));
+    uint64_t smaller = 0;
+    for (int i = 0; i < 40; i += 8) {
+        __m256i column = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(capacities + i));
+        smaller |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(rowLength, column)))) << i;
+    }
+    // The capacities grow with the version, so the smaller ones are the lowest bits
+    int count = __builtin_popcountll(smaller);
+    return count < 40 ? count + 1 : 0;
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX2)
+void classifyRowsAvx2(const int32_t* offsets, const char* bytes, const char* end, size_t first, size_t last,
+                      QrErrorCorrectionLevel level, QrBulkClassification* results) {
+    classifyRows(classifyModeAvx2, findVersionAvx2, offsets, bytes, end, first, last, level, results);
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX512)
+bool classifyModeAvx512(const char* row, size_t length, const char* end, QrMode& mode) {
+    (void)end;
+    const __m512i high = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(HighNibbleClasses)));
+    const __m512i low = _mm512_broadcast_i32x4(_mm_load_si128(reinterpret_cast<const __m128i*>(LowNibbleClasses)));
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    __mmask64 nonDigit = 0;
+    __mmask64 nonAlphanumeric = 0;
+    __mmask64 nonAscii = 0;
+    for (size_t i = 0; i < length; i += 64) {
+        // Masked loads do not touch the bytes past the row, so the end of the column needs no care
+        __mmask64 valid = length - i >= 64 ? ~static_cast<__mmask64>(0) : (static_cast<__mmask64>(1) << (length - i)) - 1;
+        __m512i chunk = _mm512_maskz_loadu_epi8(valid, row + i);
+        __m512i classes = _mm512_and_si512(_mm512_shuffle_epi8(low, _mm512_and_si512(chunk, nibble)),
+                                           _mm512_shuffle_epi8(high, _mm512_and_si512(_mm512_srli_epi16(chunk, 4), nibble)));
+        nonDigit |= _mm512_mask_testn_epi8_mask(valid, classes, _mm512_set1_epi8(DigitBits));
+        nonAlphanumeric |= _mm512_mask_testn_epi8_mask(valid, classes, _mm512_set1_epi8(AlphanumericBits));
+        nonAscii |= _mm512_movepi8_mask(chunk);
+    }
+    return selectMode(nonDigit == 0, nonAlphanumeric == 0, nonAscii == 0, row, length, mode);
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX512)
+int findVersionAvx512(size_t length, const int* capacities) {
+    __m512i rowLength = _mm512_set1_epi32(static_cast<int>(length));
+    uint64_t smaller = 0;
+    for (int i = 0; i < CapacityColumns::PaddedLength; i += 16) {
+        __m512i column = _mm512_loadu_si512(capacities + i);
+        smaller |= static_cast<uint64_t>(_mm512_cmpgt_epi32_mask(rowLength, column)) << i;
+    }
+    int count = __builtin_popcountll(smaller);
+    return count < 40 ? count + 1 : 0;
+}
+
+CPP_QR_TARGET(CPP_QR_ISA_AVX512)
+void classifyRowsAvx512(const int32_t* offsets, const char* bytes, const char* end, size_t first, size_t last,
+                        QrErrorCorrectionLevel level, QrBulkClassification* results) {
+    classifyRows(classifyModeAvx512, findVersionAvx512, offsets, bytes, end, first, last, level, results);
+}
+
+#endif
+
+/**
+ * Returns the row kernel compiled for the given level, or the closest lower one which was built.
+ */
+RowKernel getRowKernel(QrCpuLevel level) {
+#ifdef CPP_QR_CPU_VARIANTS
+    switch (level) {
+    case QrCpuLevel::Avx512:
+        return classifyRowsAvx512;
+    case QrCpuLevel::Avx2:
+        return classifyRowsAvx2;
+    case QrCpuLevel::Sse42:
+        return classifyRowsSse42;
+    default:
+        break;
+    }
+#else
+    (void)level;
+#endif
+    return classifyRowsGeneric;
+}
+
+/// The row threshold in use; the kernel level and version threshold are held by QrCpuDispatch and QrParallel.
+std::atomic<size_t> tunedParallelThreshold(4096);
+
+/// Identifies the cache file format.
+const int TuningFormat = 2;
+
+/// Version of the symbol whose mask penalty is timed.
+const int MeasuredVersion = 10;
+
+}
+
+/**
+ * Classifies every row of an Arrow style string column.
+ * Blocks of RowsPerTask rows are classified by separate tasks writing disjoint parts of results,
+ * using the kernel variant and parallel threshold of the current tuning.
+ *
+ * @param offsets The rowCount + 1 row offsets into bytes.
+ * @param bytes The concatenated row bytes.
+ * @param rowCount Number of rows.
+ * @param level The error correction level used for all rows.
+ * @param results Receives rowCount classifications.
+ * @param threadCount Maximum number of threads classifying blocks of rows.
+ * @throws InvalidColumnException if an offset is negative or smaller than the one before it.
+ */
+void QrBulkClassifier::classify(const int32_t* offsets, const char* bytes, size_t rowCount, QrErrorCorrectionLevel level,
+                                QrBulkClassification* results, int threadCount) {
+    checkOffsets(offsets, rowCount);
+
+    // Build the shared tables before any task reads them
+    getByteClasses();
+    getCapacityColumns();
+
+    QrBulkTuning tuning = getTuning();
+    RowKernel kernel = getRowKernel(tuning.kernelLevel);
+    if (rowCount < tuning.parallelThreshold) {
+        threadCount = 1;
+    }
+
+    // Vector kernels may load whole registers from a row but not past the end of the column
+    const char* end = rowCount == 0 ? bytes : bytes + offsets[rowCount];
+    size_t taskCount = (rowCount + RowsPerTask - 1) / RowsPerTask;
+    QrParallel::forEach(taskCount, threadCount, [&](size_t task) {
+        kernel(offsets, bytes, end, task * RowsPerTask, std::min(rowCount, (task + 1) * RowsPerTask), level, results);
+    });
+}
+
+/**
+ * Classifies every row of an Arrow style string column.
+ *
+ * @param offsets The row offsets; the column has offsets.size() - 1 rows.
+ * @param bytes The concatenated row bytes.
+ * @param level The error correction level used for all rows.
+ * @param threadCount Maximum number of threads classifying blocks of rows.
+ * @return One classification per row.
+ * @throws InvalidColumnException if an offset is negative, smaller than the one before it or past the end of bytes.
+ */
+std::vector<QrBulkClassification> QrBulkClassifier::classify(const std::vector<int32_t>& offsets, const std::vector<char>& bytes,
+                                                             QrErrorCorrectionLevel level, int threadCount) {
+    size_t rowCount = offsets.empty() ? 0 : offsets.size() - 1;
+    // The pointer overload checks the order of the offsets; only the end of the last row needs the buffer size
+    if (!offsets.empty() && offsets[rowCount] > 0 && static_cast<size_t>(offsets[rowCount]) > bytes.size()) {
+        throw InvalidColumnException("The last row ends past the end of the byte buffer");
+    }
+    std::vector<QrBulkClassification> results(rowCount);
+    classify(offsets.data(), bytes.data(), rowCount, level, results.data(), threadCount);
+    return results;
+}
+
+/**
+ * @return The settings in use. Until setTuning or calibrate is called, the kernels of the detected
+ *         CPU level, a threshold of one task of rows and a version threshold of 30 are used.
+ */
+QrBulkTuning QrBulkClassifier::getTuning() {
+    QrBulkTuning tuning = {QrCpuDispatch::getKernelLevel(), tunedParallelThreshold.load(), QrParallel::getVersionThreshold()};
+    return tuning;
+}
+
+/**
+ * Sets the settings used by classify, the kernel level of every dispatched kernel and the default
+ * parallel version threshold.
+ *
+ * @param tuning The settings.
+ * @throws UnsupportedCpuLevelException if this CPU cannot run the kernel level.
+ */
+void QrBulkClassifier::setTuning(const QrBulkTuning& tuning) {
+    QrCpuDispatch::setKernelLevel(tuning.kernelLevel);
+    tunedParallelThreshold.store(tuning.parallelThreshold);
+    QrParallel::setVersionThreshold(tuning.parallelVersionThreshold);
+}
+
+/**
+ * Picks the fastest kernel level and the parallel thresholds for this machine and sets them,
+ * reading them from the cache file if it was written on a machine like this one. A process measures
+ * at most once. The settings are published with setTuning, so classify calls running meanwhile
+ * finish with the settings they started with.
+ *
+ * @param cachePath The cache file, or an empty string to measure without a cache.
+ * @return The settings now in use.
+ */
+QrBulkTuning QrBulkClassifier::calibrate(const std::string& cachePath) {
+    // Later calls reuse the first measurement, so a process measures at most once
+    static std::once_flag measuredOnce;
+    static QrBulkTuning measured;
+    QrBulkTuning tuning;
+    if (cachePath.empty() || !readTuning(cachePath, tuning)) {
+        std::call_once(measuredOnce, []() {
+            measured = measureTuning();
+        });
+        tuning = measured;
+        if (!cachePath.empty()) {
+            writeTuning(cachePath, tuning);
+        }
+    }
+    setTuning(tuning);
+    return tuning;
+}
+
+/**
+ * Measures the settings for this machine.
+ * The row kernel of every supported level classifies a column of typical catalog rows and the fastest
+ * one wins. The row threshold is the number of rows whose classification on a second thread saves more
+ * time than handing them to a pool thread costs, and the version threshold the smallest version whose
+ * eight mask candidates do.
+ *
+ * @return The measured settings.
+ */
+QrBulkTuning QrBulkClassifier::measureTuning() {
+    static const std::string alphabets[] = {"0123456789", "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ-./",
+                                            "abcdefghijklmnopqrstuvwxyz0123456789-_"};
+    const size_t rowCount = 4 * RowsPerTask;
+    std::vector<int32_t> offsets(1, 0);
+    std::vector<char> bytes;
+    uint32_t state = 41;
+    for (size_t row = 0; row < rowCount; ++row) {
+        state = state * 1664525u + 1013904223u;
+        const std::string& alphabet = alphabets[(state >> 24) % 3];
+        size_t length = 8 + (state >> 16) % 24;
+        for (size_t i = 0; i < length; ++i) {
+            state = state * 1664525u + 1013904223u;
+            bytes.push_back(alphabet[(state >> 16) % alphabet.size()]);
+        }
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+    }
+    std::vector<QrBulkClassification> results(rowCount);
+    getByteClasses();
+    getCapacityColumns();
+
+    QrModuleMatrix symbol = QrModuleMatrix::fromVersion(MeasuredVersion);
+    for (int row = 0; row < symbol.size(); ++row) {
+        for (int col = 0; col < symbol.size(); ++col) {
+            state = state * 1664525u + 1013904223u;
+            symbol.set(row, col, (state >> 31) != 0);
+        }
+    }
+
+    // The kernels are called directly, so encodes on other threads keep the published level meanwhile
+    const char* end = bytes.data() + bytes.size();
+    QrBulkTuning tuning = {QrCpuLevel::Generic, 0, 0};
+    double rowSeconds = std::numeric_limits<double>::max();
+    for (int kernelLevel = 0; kernelLevel <= static_cast<int>(QrCpuDispatch::detectLevel()); ++kernelLevel) {
+        RowKernel kernel = getRowKernel(static_cast<QrCpuLevel>(kernelLevel));
+        for (int run = 0; run < 3; ++run) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            kernel(offsets.data(), bytes.data(), end, 0, rowCount, QrErrorCorrectionLevel::MEDIUM, results.data());
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rowCount;
+            if (seconds < rowSeconds) {
+                rowSeconds = seconds;
+                tuning.kernelLevel = static_cast<QrCpuLevel>(kernelLevel);
+            }
+        }
+    }
+
+    double maskSeconds = std::numeric_limits<double>::max();
+    for (int run = 0; run < 3; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int mask = 0; mask < QrMaskSelector::MaskCount; ++mask) {
+            QrMaskSelector::getPenalty(symbol);
+        }
+        maskSeconds = std::min(maskSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    if (std::thread::hardware_concurrency() < 2) {
+        // A second thread only competes with the first one for the single core
+        tuning.parallelThreshold = std::numeric_limits<size_t>::max();
+        tuning.parallelVersionThreshold = 41;
+        return tuning;
+    }
+    double startSeconds = std::numeric_limits<double>::max();
+    for (int run = 0; run < 5; ++run) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        QrParallel::forEach(2, 2, [](size_t) {});
+        startSeconds = std::min(startSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    size_t minimum = RowsPerTask;
+    tuning.parallelThreshold = std::max(minimum, static_cast<size_t>(2 * startSeconds / std::max(rowSeconds, 1e-12)));
+
+    // The mask penalty grows with the number of modules
+    int measuredSize = QrModuleMatrix::sizeForVersion(MeasuredVersion);
+    tuning.parallelVersionThreshold = 1;
+    while (tuning.parallelVersionThreshold <= 40) {
+        double size = QrModuleMatrix::sizeForVersion(tuning.parallelVersionThreshold);
+        if (maskSeconds * size * size / (measuredSize * measuredSize) > 2 * startSeconds) {
+            break;
+        }
+        ++tuning.parallelVersionThreshold;
+    }
+    return tuning;
+}
+
+/**
+ * Checks that the offsets are not negative and do not decrease, so every row length is a valid size.
+ *
+ * @param offsets The rowCount + 1 row offsets.
+ * @param rowCount Number of rows.
+ * @throws InvalidColumnException if an offset is negative or smaller than the one before it.
+ */
+void QrBulkClassifier::checkOffsets(const int32_t* offsets, size_t rowCount) {
+    if (rowCount == 0) {
+        return;
+    }
+    if (offsets[0] < 0) {
+        throw InvalidColumnException("Row offsets cannot be negative");
+    }
+    for (size_t row = 0; row < rowCount; ++row) {
+        if (offsets[row + 1] < offsets[row]) {
+            throw InvalidColumnException("Row offset " + std::to_string(row + 1) + " is smaller than the one before it");
+        }
+    }
+}
+
+/**
+ * Reads settings from the cache file.
+ *
+ * @param path The cache file.
+ * @param tuning Receives the settings.
+ * @return True if the file holds settings for a machine with this CPU level and core count; false if it is
+ *         missing, corrupted or was written on another machine.
+ */
+bool QrBulkClassifier::readTuning(const std::string& path, QrBulkTuning& tuning) {
+    std::ifstream input(path);
+    if (!input) {
+        return false;
+    }
+
+    std::string key;
+    std::string cpu;
+    std::string kernel;
+    int format = 0;
+    unsigned int cores = 0;
+    int found = 0;
+    while (input >> key) {
+        if (key == "format") {
+            found += static_cast<bool>(input >> format);
+        } else if (key == "cpu") {
+            found += static_cast<bool>(input >> cpu);
+        } else if (key == "cores") {
+            found += static_cast<bool>(input >> cores);
+        } else if (key == "kernel") {
+            found += static_cast<bool>(input >> kernel);
+        } else if (key == "threshold") {
+            found += static_cast<bool>(input >> tuning.parallelThreshold);
+        } else if (key == "versions") {
+            found += static_cast<bool>(input >> tuning.parallelVersionThreshold);
+        }
+    }
+    return found == 6 && format == TuningFormat && tuning.parallelVersionThreshold >= 1 && tuning.parallelVersionThreshold <= 41 &&
+           cpu == QrCpuDispatch::getLevelName(QrCpuDispatch::detectLevel()) &&
+           cores == std::thread::hardware_concurrency() &&
+           QrCpuDispatch::parseLevelName(kernel, tuning.kernelLevel) && QrCpuDispatch::isSupported(tuning.kernelLevel);
+}
+
+/**
+ * Writes settings to the cache file atomically by renaming a temporary file over it.
+ * The cache only saves time, so a file which cannot be written is left alone.
+ *
+ * @param path The cache file.
+ * @param tuning The settings to write.
+ */
+void QrBulkClassifier::writeTuning(const std::string& path, const QrBulkTuning& tuning) {
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::trunc);
+        output << "format " << TuningFormat << '\n'
+               << "cpu " << QrCpuDispatch::getLevelName(QrCpuDispatch::detectLevel()) << '\n'
+               << "cores " << std::thread::hardware_concurrency() << '\n'
+               << "kernel " << QrCpuDispatch::getLevelName(tuning.kernelLevel) << '\n'
+               << "threshold " << tuning.parallelThreshold << '\n'
+               << "versions " << tuning.parallelVersionThreshold << '\n';
+        output.flush();
+        if (!output) {
+            output.close();
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+    }
+}
@@ -0,0 +1,441 @@
+#include "../include/QrBulkJob.hpp"
+#include "../include/QrModeSelector.hpp"
+#include "../include/QrVersionSelector.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// Output names of the modes, indexed by QrMode.
+const char* const modeNames[] = {"numeric", "alphanumeric", "byte", "kanji"};
+
+}
+
+/**
+ * Constructs an InvalidShardException with a specific error message.
+ *
+ * @param message The error message describing the problem.
+ */
+InvalidShardException::InvalidShardException(const std::string& message)
+    : std::runtime_error(message) {}
+
+/**
+ * Parses a shard specification written as "index/count".
+ *
+ * @param spec The specification, for example "2/8".
+ * @return The parsed shard.
+ * @throws InvalidShardException if the specification is malformed or out of range.
+ */
+QrShardSpec QrBulkJob::parseShardSpec(const std::string& spec) {
+    QrShardSpec shard;
+    char separator = 0;
+    std::istringstream in(spec);
+    if (!(in >> shard.index >> separator >> shard.count) || separator != '/' || !in.eof()) {
+        throw InvalidShardException("Shard specification \"" + spec + "\" is not in the form index/count");
+    }
+    if (shard.count < 1 || shard.index < 0 || shard.index >= shard.count) {
+        throw InvalidShardException("Shard specification \"" + spec + "\" is out of range");
+    }
+    return shard;
+}
+
+/**
+ * Computes the byte range of the input handled by a shard.
+ *
+ * @param inputPath The input file.
+ * @param shard The shard.
+ * @return The range, starting and ending at record boundaries.
+ * @throws InvalidShardException if the shard is out of range or the input cannot be read.
+ */
+QrByteRange QrBulkJob::getShardRange(const std::string& inputPath, const QrShardSpec& shard) {
+    if (shard.count < 1 || shard.index < 0 || shard.index >= shard.count) {
+        throw InvalidShardException("Shard " + std::to_string(shard.index) + "/" + std::to_string(shard.count) + " is out of range");
+    }
+
+    std::ifstream input(inputPath, std::ios::binary | std::ios::ate);
+    if (!input) {
+        throw InvalidShardException("Cannot read input file \"" + inputPath + "\"");
+    }
+    uint64_t fileSize = static_cast<uint64_t>(input.tellg());
+
+    QrByteRange range;
+    range.begin = alignToRecord(inputPath, fileSize * shard.index / shard.count, fileSize);
+    range.end = alignToRecord(inputPath, fileSize * (shard.index + 1) / shard.count, fileSize);
+    return range;
+}
+
+/**
+ * Processes the records of a shard, resuming from the checkpoint manifest if one exists.
+ * Output written after the last checkpoint is discarded on resume, so every record appears exactly once.
+ * Before a manifest is written the output is synced to disk, so a checkpoint never counts lost output.
+ *
+ * @param inputPath The input file.
+ * @param outputPath The output file of the shard.
+ * @param shard The shard.
+ * @param options The encode options.
+ * @param checkpointBytes Number of input bytes processed between checkpoints.
+ * @return The total number of records in the shard output.
+ */
+size_t QrBulkJob::run(const std::string& inputPath, const std::string& outputPath, const QrShardSpec& shard,
+                      const QrEncodeOptions& options, uint64_t checkpointBytes) {
+    QrByteRange range = getShardRange(inputPath, shard);
+    std::string manifestPath = getManifestPath(outputPath);
+
+    Manifest manifest;
+    if (readManifest(manifestPath, manifest)) {
+        if (manifest.shard.index != shard.index || manifest.shard.count != shard.count ||
+            manifest.range.begin != range.begin || manifest.range.end != range.end || !isSameJob(manifest.options, options)) {
+            throw InvalidShardException("Manifest \"" + manifestPath + "\" belongs to a different shard, input or options");
+        }
+        if (manifest.complete) {
+            return manifest.records;
+        }
+        // The manifest is only written after the output is synced, so a shorter output is not ours to extend
+        struct stat outputStat;
+        if (::stat(outputPath.c_str(), &outputStat) != 0 || static_cast<uint64_t>(outputStat.st_size) < manifest.outputBytes) {
+            throw InvalidShardException("Output file \"" + outputPath + "\" is shorter than its last checkpoint");
+        }
+        if (::truncate(outputPath.c_str(), static_cast<off_t>(manifest.outputBytes)) != 0) {
+            throw InvalidShardException("Cannot truncate output file \"" + outputPath + "\" to the last checkpoint");
+        }
+    } else {
+        manifest.shard = shard;
+        manifest.range = range;
+        manifest.nextOffset = range.begin;
+        manifest.outputBytes = 0;
+        manifest.records = 0;
+        manifest.complete = false;
+        manifest.options = options;
+        std::ofstream(outputPath, std::ios::binary | std::ios::trunc);
+        syncFile(outputPath);
+        writeManifest(manifestPath, manifest);
+    }
+
+    std::ifstream input(inputPath, std::ios::binary);
+    std::ofstream output(outputPath, std::ios::binary | std::ios::app);
+    if (!input || !output) {
+        throw InvalidShardException("Cannot open input \"" + inputPath + "\" or output \"" + outputPath + "\"");
+    }
+    input.seekg(static_cast<std::streamoff>(manifest.nextOffset));
+
+    std::string record;
+    uint64_t checkpointOffset = manifest.nextOffset;
+    while (manifest.nextOffset < range.end && std::getline(input, record)) {
+        std::string line = formatRecord(manifest.nextOffset, record, options);
+        output << line;
+
+        manifest.nextOffset += record.size() + (input.eof() ? 0 : 1);
+        manifest.outputBytes += line.size();
+        ++manifest.records;
+
+        if (manifest.nextOffset - checkpointOffset >= checkpointBytes) {
+            output.flush();
+            if (!output) {
+                throw InvalidShardException("Cannot write output file \"" + outputPath + "\"");
+            }
+            // The manifest must never count output bytes which are not on disk yet
+            syncFile(outputPath);
+            writeManifest(manifestPath, manifest);
+            checkpointOffset = manifest.nextOffset;
+        }
+    }
+
+    output.flush();
+    if (!output) {
+        throw InvalidShardException("Cannot write output file \"" + outputPath + "\"");
+    }
+    syncFile(outputPath);
+    manifest.complete = true;
+    writeManifest(manifestPath, manifest);
+    return manifest.records;
+}
+
+/**
+ * Validates complete shard outputs and concatenates them into one ordered result.
+ * Every record must start right after the previous one, so gaps and overlaps between shards are detected
+ * without touching the input. All shards must have the options of the first one, and every record must
+ * carry a mode, version and mask which these options can produce.
+ *
+ * @param shardOutputs Output files of all shards, ordered by shard index.
+ * @param mergedPath The merged output file.
+ * @return The number of merged records.
+ */
+size_t QrBulkJob::merge(const std::vector<std::string>& shardOutputs, const std::string& mergedPath) {
+    std::ofstream merged(mergedPath, std::ios::binary | std::ios::trunc);
+    if (!merged) {
+        throw InvalidShardException("Cannot write merged file \"" + mergedPath + "\"");
+    }
+
+    uint64_t expectedOffset = 0;
+    size_t records = 0;
+    QrEncodeOptions jobOptions;
+    for (size_t i = 0; i < shardOutputs.size(); ++i) {
+        Manifest manifest;
+        if (!readManifest(getManifestPath(shardOutputs[i]), manifest) || !manifest.complete) {
+            throw InvalidShardException("Shard output \"" + shardOutputs[i] + "\" is missing or incomplete");
+        }
+        if (manifest.shard.index != static_cast<int>(i) || manifest.shard.count != static_cast<int>(shardOutputs.size())) {
+            throw InvalidShardException("Shard output \"" + shardOutputs[i] + "\" is not shard " + std::to_string(i) + "/" + std::to_string(shardOutputs.size()));
+        }
+        if (i == 0) {
+            jobOptions = manifest.options;
+        } else if (!isSameJob(manifest.options, jobOptions)) {
+            throw InvalidShardException("Shard output \"" + shardOutputs[i] + "\" was written with other options than shard 0");
+        }
+        if (manifest.range.begin != expectedOffset) {
+            throw InvalidShardException("Shard output \"" + shardOutputs[i] + "\" does not continue the previous shard");
+        }
+
+        std::ifstream shardOutput(shardOutputs[i], std::ios::binary);
+        std::string line;
+        size_t shardRecords = 0;
+        while (std::getline(shardOutput, line)) {
+            std::istringstream fields(line);
+            uint64_t offset = 0;
+            uint64_t length = 0;
+            if (!(fields >> offset >> length) || offset != expectedOffset) {
+                throw InvalidShardException("Record at offset " + std::to_string(expectedOffset) + " is missing from \"" + shardOutputs[i] + "\"");
+            }
+            if (!isConsistentRecord(fields, length, manifest.options)) {
+                throw InvalidShardException("Record at offset " + std::to_string(offset) + " in \"" + shardOutputs[i] + "\" does not match the job options");
+            }
+            merged << line << '\n';
+            expectedOffset = offset + length + 1;
+            ++shardRecords;
+        }
+
+        // The last record of the input may end without a newline
+        if (shardRecords != manifest.records || (expectedOffset != manifest.range.end && expectedOffset != manifest.range.end + 1)) {
+            throw InvalidShardException("Shard output \"" + shardOutputs[i] + "\" does not match its manifest");
+        }
+        expectedOffset = manifest.range.end;
+        records += shardRecords;
+    }
+
+    merged.flush();
+    if (!merged) {
+        throw InvalidShardException("Cannot write merged file \"" + mergedPath + "\"");
+    }
+    return records;
+}
+
+/**
+ * @param outputPath The output file of a shard.
+ * @return The path of its checkpoint manifest.
+ */
+std::string QrBulkJob::getManifestPath(const std::string& outputPath) {
+    return outputPath + ".manifest";
+}
+
+/**
+ * Finds the first record boundary at or after the offset.
+ * A record starts at the beginning of the file or right after a newline.
+ *
+ * @param inputPath The input file.
+ * @param offset The nominal offset.
+ * @param fileSize Size of the input file.
+ * @return The offset of the first record starting at or after the nominal offset, or the file size.
+ */
+uint64_t QrBulkJob::alignToRecord(const std::string& inputPath, uint64_t offset, uint64_t fileSize) {
+    if (offset == 0 || offset >= fileSize) {
+        return offset == 0 ? 0 : fileSize;
+    }
+
+    std::ifstream input(inputPath, std::ios::binary);
+    input.seekg(static_cast<std::streamoff>(offset - 1));
+    std::string skipped;
+    std::getline(input, skipped);
+    if (input.eof()) {
+        return fileSize;
+    }
+    return offset + skipped.size();
+}
+
+/**
+ * Reads a manifest, returning false if it does not exist.
+ *
+ * @param path The manifest file.
+ * @param manifest Receives the manifest.
+ * @return True if the manifest was read; false otherwise.
+ */
+bool QrBulkJob::readManifest(const std::string& path, Manifest& manifest) {
+    std::ifstream input(path);
+    if (!input) {
+        return false;
+    }
+
+    std::string key;
+    int complete = 0;
+    int level = 0;
+    int maskStrategy = 0;
+    int found = 0;
+    while (input >> key) {
+        if (key == "shard") {
+            found += static_cast<bool>(input >> manifest.shard.index >> manifest.shard.count);
+        } else if (key == "range") {
+            found += static_cast<bool>(input >> manifest.range.begin >> manifest.range.end);
+        } else if (key == "next") {
+            found += static_cast<bool>(input >> manifest.nextOffset);
+        } else if (key == "output") {
+            found += static_cast<bool>(input >> manifest.outputBytes);
+        } else if (key == "records") {
+            found += static_cast<bool>(input >> manifest.records);
+        } else if (key == "complete") {
+            found += static_cast<bool>(input >> complete);
+        } else if (key == "options") {
+            found += static_cast<bool>(input >> level >> maskStrategy >> manifest.options.fixedMask);
+        }
+    }
+    if (found != 7 || level < 0 || level > static_cast<int>(QrErrorCorrectionLevel::HIGH) ||
+        maskStrategy < 0 || maskStrategy > static_cast<int>(QrMaskStrategy::Fixed)) {
+        throw InvalidShardException("Manifest \"" + path + "\" is corrupted");
+    }
+    manifest.complete = complete != 0;
+    manifest.options.level = static_cast<QrErrorCorrectionLevel>(level);
+    manifest.options.maskStrategy = static_cast<QrMaskStrategy>(maskStrategy);
+    return true;
+}
+
+/**
+ * Writes a manifest atomically by renaming a temporary file over it.
+ * The temporary file is synced before the rename and the directory after it, so after a crash the
+ * manifest is either the previous one or the complete new one.
+ *
+ * @param path The manifest file.
+ * @param manifest The manifest to write.
+ */
+void QrBulkJob::writeManifest(const std::string& path, const Manifest& manifest) {
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::trunc);
+        output << "shard " << manifest.shard.index << ' ' << manifest.shard.count << '\n'
+               << "range " << manifest.range.begin << ' ' << manifest.range.end << '\n'
+               << "next " << manifest.nextOffset << '\n'
+               << "output " << manifest.outputBytes << '\n'
+               << "records " << manifest.records << '\n'
+               << "complete " << (manifest.complete ? 1 : 0) << '\n'
+               << "options " << static_cast<int>(manifest.options.level) << ' '
+               << static_cast<int>(manifest.options.maskStrategy) << ' ' << manifest.options.fixedMask << '\n';
+        output.flush();
+        if (!output) {
+            throw InvalidShardException("Cannot write manifest \"" + temporaryPath + "\"");
+        }
+    }
+    syncFile(temporaryPath);
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        throw InvalidShardException("Cannot replace manifest \"" + path + "\"");
+    }
+    // The rename itself is only durable once the directory entry is synced
+    size_t separator = path.find_last_of('/');
+    syncFile(separator == std::string::npos ? "." : separator == 0 ? "/" : path.substr(0, separator));
+}
+
+/**
+ * Flushes a file or directory to disk with fsync.
+ *
+ * @param path The file or directory.
+ * @throws InvalidShardException if the file cannot be opened or synced.
+ */
+void QrBulkJob::syncFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw InvalidShardException("Cannot open \"" + path + "\" to sync it");
+    }
+    int result = ::fsync(fd);
+    ::close(fd);
+    if (result != 0) {
+        throw InvalidShardException("Cannot sync \"" + path + "\" to disk");
+    }
+}
+
+/**
+ * Checks whether two jobs use the same level and mask. The fixed mask only matters for QrMaskStrategy::Fixed.
+ *
+ * @param first The options of one job.
+ * @param second The options of the other job.
+ * @return True if both jobs produce the same output; false otherwise.
+ */
+bool QrBulkJob::isSameJob(const QrEncodeOptions& first, const QrEncodeOptions& second) {
+    return first.level == second.level && formatMask(first) == formatMask(second);
+}
+
+/**
+ * Formats the mask column of the output for the options.
+ *
+ * @param options The encode options.
+ * @return The fixed mask of QrMaskStrategy::Fixed, or "auto" if the encoder scores the masks.
+ */
+std::string QrBulkJob::formatMask(const QrEncodeOptions& options) {
+    return options.maskStrategy == QrMaskStrategy::Fixed ? std::to_string(options.fixedMask) : "auto";
+}
+
+/**
+ * Formats the output line of one record.
+ *
+ * @param offset Byte offset of the record in the input.
+ * @param record The record without its newline.
+ * @param options The encode options.
+ * @return The output line including its newline.
+ */
+std::string QrBulkJob::formatRecord(uint64_t offset, const std::string& record, const QrEncodeOptions& options) {
+    // Tolerate CRLF line endings
+    std::string message = record;
+    if (!message.empty() && message[message.size() - 1] == '\r') {
+        message.erase(message.size() - 1);
+    }
+
+    const char* modeName = "invalid";
+    int version = 0;
+    try {
+        QrMode mode = QrModeSelector::getQrMode(message);
+        version = QrVersionSelector::getQrVersion(message.length(), options.level, mode);
+        modeName = modeNames[static_cast<int>(mode)];
+    } catch (const std::invalid_argument&) {
+        version = 0;
+    }
+
+    std::ostringstream line;
+    line << offset << '\t' << record.size() << '\t' << modeName << '\t' << version << '\t' << formatMask(options) << '\n';
+    return line.str();
+}
+
+/**
+ * Checks that the mode, version and mask of an output line agree with the job options.
+ * The version must be the one the level selects for the record length, or for the length without a
+ * trailing carriage return, which formatRecord strips.
+ *
+ * @param fields The output line, positioned after the offset and length.
+ * @param length The length of the record in the input.
+ * @param options The options of the job.
+ * @return True if the record could have been written with the options; false otherwise.
+ */
+bool QrBulkJob::isConsistentRecord(std::istream& fields, uint64_t length, const QrEncodeOptions& options) {
+    std::string modeName;
+    int version = 0;
+    std::string mask;
+    if (!(fields >> modeName >> version >> mask) || mask != formatMask(options)) {
+        return false;
+    }
+    if (modeName == "invalid") {
+        return version == 0;
+    }
+
+    for (int mode = 0; mode < 4; ++mode) {
+        if (modeName != modeNames[mode]) {
+            continue;
+        }
+        for (uint64_t messageLength = length; messageLength > 0 && messageLength + 1 >= length; --messageLength) {
+            try {
+                if (QrVersionSelector::getQrVersion(messageLength, options.level, static_cast<QrMode>(mode)) == version) {
+                    return true;
+                }
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    }
+    return false;
+}
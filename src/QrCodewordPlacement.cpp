@@ -0,0 +1,159 @@
+#include "../include/QrCodewordPlacement.hpp"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Returns the placement table of a version, building it on first use.
+ *
+ * @param version The version selected by QrVersionSelector::getQrVersion.
+ * @return The placement table.
+ * @throws InvalidVersionException if the version is outside of 1-40.
+ */
+const QrPlacementTable& QrCodewordPlacement::getTable(int version) {
+    static std::once_flag built[40];
+    static std::unique_ptr<QrPlacementTable> tables[40];
+
+    QrModuleMatrix::sizeForVersion(version);
+    std::call_once(built[version - 1], [version]() {
+        tables[version - 1].reset(new QrPlacementTable(buildTable(version)));
+    });
+    return *tables[version - 1];
+}
+
+/**
+ * Writes codeword bits, most significant bit first, into the data modules of the matrix.
+ *
+ * @param codewords The interleaved data and error correction codewords.
+ * @param table The placement table of the matrix version.
+ * @param matrix The matrix receiving the bits.
+ * @throws std::invalid_argument if there are more codeword bits than data modules or the matrix has the wrong size.
+ */
+void QrCodewordPlacement::placeCodewords(const std::vector<uint8_t>& codewords, const QrPlacementTable& table, QrModuleMatrix& matrix) {
+    if (matrix.size() != table.reserved.size()) {
+        throw std::invalid_argument("Matrix size does not match the placement table version");
+    }
+    if (codewords.size() * 8 > table.positions.size()) {
+        throw std::invalid_argument("Too many codewords for version " + std::to_string(table.version));
+    }
+
+    const QrModulePosition* position = table.positions.data();
+    for (uint8_t codeword : codewords) {
+        for (int bit = 7; bit >= 0; --bit, ++position) {
+            uint64_t mask = static_cast<uint64_t>(1) << position->bit;
+            uint64_t& word = matrix.rowData(position->row)[position->word];
+            word = (word & ~mask) | (static_cast<uint64_t>(-((codeword >> bit) & 1)) & mask);
+        }
+    }
+}
+
+/**
+ * Returns the centre coordinates of the alignment patterns of a version.
+ * The first coordinate is always 6 and the others are evenly spaced from the last one, size - 7, downwards.
+ *
+ * @param version The version (1-40).
+ * @return The coordinates used for both rows and columns; empty for version 1.
+ */
+std::vector<int> QrCodewordPlacement::getAlignmentPositions(int version) {
+    int size = QrModuleMatrix::sizeForVersion(version);
+    if (version == 1) {
+        return std::vector<int>();
+    }
+
+    int count = version / 7 + 2;
+    int step = (version == 32) ? 26 : (version * 4 + count * 2 + 1) / (count * 2 - 2) * 2;
+
+    std::vector<int> positions(count);
+    positions[0] = 6;
+    for (int i = count - 1, position = size - 7; i >= 1; --i, position -= step) {
+        positions[i] = position;
+    }
+    return positions;
+}
+
+/**
+ * Builds the placement table of a version by walking the zig-zag once.
+ *
+ * @param version The version (1-40).
+ * @return The placement table.
+ */
+QrPlacementTable QrCodewordPlacement::buildTable(int version) {
+    QrPlacementTable table = {version, QrModuleMatrix::fromVersion(version), std::vector<QrModulePosition>()};
+    reserveFunctionPatterns(version, table.reserved);
+
+    int size = table.reserved.size();
+    for (int right = size - 1; right >= 1; right -= 2) {
+        // The vertical timing pattern column is skipped entirely
+        if (right == 6) {
+            right = 5;
+        }
+        bool upwards = ((right + 1) & 2) == 0;
+        for (int vertical = 0; vertical < size; ++vertical) {
+            int row = upwards ? size - 1 - vertical : vertical;
+            for (int col = right; col >= right - 1; --col) {
+                if (!table.reserved.get(row, col)) {
+                    QrModulePosition position = {
+                        static_cast<uint8_t>(row), static_cast<uint8_t>(col / 64), static_cast<uint8_t>(col % 64)
+                    };
+                    table.positions.push_back(position);
+                }
+            }
+        }
+    }
+    return table;
+}
+
+/**
+ * Marks the modules used by function patterns.
+ *
+ * @param version The version (1-40).
+ * @param reserved The matrix receiving the marks.
+ */
+void QrCodewordPlacement::reserveFunctionPatterns(int version, QrModuleMatrix& reserved) {
+    int size = reserved.size();
+
+    // Finder patterns with their separators and the format information next to them
+    reserveRectangle(reserved, 0, 0, 9, 9);
+    reserveRectangle(reserved, 0, size - 8, 9, 8);
+    reserveRectangle(reserved, size - 8, 0, 8, 9);
+
+    // Timing patterns
+    reserveRectangle(reserved, 6, 0, 1, size);
+    reserveRectangle(reserved, 0, 6, size, 1);
+
+    // Alignment patterns, except where they would overlap the finder patterns
+    std::vector<int> alignment = getAlignmentPositions(version);
+    for (size_t i = 0; i < alignment.size(); ++i) {
+        for (size_t j = 0; j < alignment.size(); ++j) {
+            bool overlapsFinder = (i == 0 && j == 0) || (i == 0 && j == alignment.size() - 1) || (i == alignment.size() - 1 && j == 0);
+            if (!overlapsFinder) {
+                reserveRectangle(reserved, alignment[i] - 2, alignment[j] - 2, 5, 5);
+            }
+        }
+    }
+
+    // Version information
+    if (version >= 7) {
+        reserveRectangle(reserved, 0, size - 11, 6, 3);
+        reserveRectangle(reserved, size - 11, 0, 3, 6);
+    }
+}
+
+/**
+ * Marks a rectangle of modules, clipped to the matrix.
+ *
+ * @param reserved The matrix receiving the marks.
+ * @param top First row of the rectangle.
+ * @param left First column of the rectangle.
+ * @param height Number of rows.
+ * @param width Number of columns.
+ */
+void QrCodewordPlacement::reserveRectangle(QrModuleMatrix& reserved, int top, int left, int height, int width) {
+    for (int row = std::max(top, 0); row < top + height && row < reserved.size(); ++row) {
+        for (int col = std::max(left, 0); col < left + width && col < reserved.size(); ++col) {
+            reserved.set(row, col, true);
+        }
+    }
+}
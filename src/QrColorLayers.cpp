@@ -0,0 +1,297 @@
+#include "../include/QrColorLayers.hpp"
+#include "../include/QrRowRenderer.hpp"
+#include "../include/QrVersionSelector.hpp"
+#include <algorithm>
+
+/**
+ * Constructs an InvalidColorLayerException with a specific error message.
+ *
+ * @param message The error message describing the problem.
+ */
+InvalidColorLayerException::InvalidColorLayerException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+/**
+ * Splits a payload into LayerCount parts of about the same byte length at character boundaries of its mode.
+ *
+ * @param payload The payload.
+ * @return The parts in layer order; concatenated they give the payload.
+ * @throws EmptyInputMessageException if the payload is empty.
+ * @throws InvalidInputMessageException if the payload cannot be encoded in any mode.
+ * @throws InvalidColorLayerException if the payload has fewer than LayerCount characters.
+ */
+std::vector<std::string> QrColorLayers::splitPayload(const std::string& payload) {
+    QrMode mode = QrModeSelector::getQrMode(payload);
+    std::vector<size_t> starts = getCharacterStarts(payload, mode);
+    if (starts.size() < static_cast<size_t>(LayerCount)) {
+        throw InvalidColorLayerException("Color symbols need at least " + std::to_string(LayerCount) + " characters");
+    }
+
+    std::vector<std::string> layers;
+    size_t previousIndex = 0;
+    for (int layer = 1; layer <= LayerCount; ++layer) {
+        size_t index = starts.size();
+        if (layer < LayerCount) {
+            // First character starting at or after the target, keeping at least one character in every layer
+            size_t target = payload.length() * layer / LayerCount;
+            index = std::lower_bound(starts.begin(), starts.end(), target) - starts.begin();
+            index = std::max(index, previousIndex + 1);
+            index = std::min(index, starts.size() - (LayerCount - layer));
+        }
+        size_t begin = starts[previousIndex];
+        size_t end = index < starts.size() ? starts[index] : payload.length();
+        layers.push_back(payload.substr(begin, end - begin));
+        previousIndex = index;
+    }
+    return layers;
+}
+
+/**
+ * Splits a payload and selects the mode and version of every layer.
+ *
+ * @param payload The payload.
+ * @param options The encode options; colorModel must not be QrColorModel::None.
+ * @return The plan of the symbol.
+ * @throws InvalidColorLayerException if color layers are not enabled or the payload is too short.
+ * @throws TooLongMessageException if a layer does not fit in any version.
+ */
+QrColorLayerPlan QrColorLayers::plan(const std::string& payload, const QrEncodeOptions& options) {
+    if (options.colorModel == QrColorModel::None) {
+        throw InvalidColorLayerException("Color layers are not enabled in the encode options");
+    }
+
+    QrColorLayerPlan result;
+    result.layers = splitPayload(payload);
+    result.modes.assign(LayerCount, QrMode::ByteMode);
+    result.versions.assign(LayerCount, 0);
+    // Selecting a mode and version is cheap next to starting a thread, so the layers are planned serially
+    for (int layer = 0; layer < LayerCount; ++layer) {
+        result.modes[layer] = QrModeSelector::getQrMode(result.layers[layer]);
+        result.versions[layer] = QrVersionSelector::getQrVersion(result.layers[layer], options.level, result.modes[layer]);
+    }
+    result.version = *std::max_element(result.versions.begin(), result.versions.end());
+    return result;
+}
+
+/**
+ * Joins decoded layers back into the payload.
+ *
+ * @param layers The layer contents in layer order.
+ * @return The payload.
+ */
+std::string QrColorLayers::joinLayers(const std::vector<std::string>& layers) {
+    std::string payload;
+    for (const std::string& layer : layers) {
+        payload += layer;
+    }
+    return payload;
+}
+
+/**
+ * Writes the layers as a color image, either an RGB composite or CMY ink separations.
+ * Every layer is expanded row by row with QrRowRenderer, and the RGB composite combines the rows of the layers.
+ *
+ * @param layers LayerCount module matrices of the same size.
+ * @param model The color model of the image.
+ * @param dotsPerModule Width and height of one module in pixels.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @param out The stream receiving the image.
+ * @throws InvalidColorLayerException if the layers, model or scale are invalid.
+ */
+void QrColorLayers::writeImage(const std::vector<QrModuleMatrix>& layers, QrColorModel model, int dotsPerModule, int quietZone,
+                               std::ostream& out) {
+    checkLayers(layers, dotsPerModule, quietZone);
+    std::vector<QrRowRenderer> renderers;
+    renderers.reserve(LayerCount);
+    for (const QrModuleMatrix& layer : layers) {
+        renderers.push_back(QrRowRenderer(layer, dotsPerModule, quietZone));
+    }
+    int dots = renderers[0].size();
+
+    if (model == QrColorModel::Rgb) {
+        out << "P6\n" << dots << ' ' << dots << "\n255\n";
+        std::vector<unsigned char> row(dots * 3);
+        const unsigned char* scanlines[LayerCount];
+        for (int y = 0; y < dots; ++y) {
+            bool repeated = true;
+            for (int channel = 0; channel < LayerCount; ++channel) {
+                scanlines[channel] = renderers[channel].nextRow();
+                repeated = repeated && renderers[channel].repeatsPreviousRow();
+            }
+            // All layers have the same size, so they change module row together; a repeated row is already combined
+            if (!repeated) {
+                for (int x = 0; x < dots; ++x) {
+                    for (int channel = 0; channel < LayerCount; ++channel) {
+                        bool dark = (scanlines[channel][x / 8] >> (7 - x % 8)) & 1;
+                        row[x * 3 + channel] = dark ? 0 : 255;
+                    }
+                }
+            }
+            out.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+    } else if (model == QrColorModel::Cmy) {
+        // Cyan ink absorbs red, magenta green and yellow blue, so the print matches the RGB composite.
+        // Packed renderer rows are already P4 rows.
+        for (QrRowRenderer& renderer : renderers) {
+            out << "P4\n" << dots << ' ' << dots << '\n';
+            while (const unsigned char* row = renderer.nextRow()) {
+                out.write(reinterpret_cast<const char*>(row), renderer.bytesPerRow());
+            }
+        }
+    } else {
+        throw InvalidColorLayerException("Color images need the Rgb or Cmy color model");
+    }
+}
+
+/**
+ * Reads the layers back from an image written by writeImage, sampling the centre of every module.
+ * RGB channels darker than half intensity count as dark modules.
+ *
+ * @param in The stream holding the image.
+ * @param model The color model of the image.
+ * @param dotsPerModule Width and height of one module in pixels.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @return LayerCount module matrices.
+ * @throws InvalidColorLayerException if the image is malformed or does not match the scale.
+ */
+std::vector<QrModuleMatrix> QrColorLayers::readImage(std::istream& in, QrColorModel model, int dotsPerModule, int quietZone) {
+    if (dotsPerModule < 1 || quietZone < 0) {
+        throw InvalidColorLayerException("Dots per module must be positive and the quiet zone cannot be negative");
+    }
+
+    std::vector<QrModuleMatrix> layers;
+    int width = 0;
+    int height = 0;
+    if (model == QrColorModel::Rgb) {
+        readHeader(in, "P6", width, height);
+        int size = getSymbolSize(width, height, dotsPerModule, quietZone);
+        layers.assign(LayerCount, QrModuleMatrix(size));
+        std::vector<unsigned char> row(width * 3);
+        for (int y = 0; y < height; ++y) {
+            if (!in.read(reinterpret_cast<char*>(row.data()), row.size())) {
+                throw InvalidColorLayerException("Color image is truncated");
+            }
+            int moduleRow = y / dotsPerModule - quietZone;
+            if (y % dotsPerModule != dotsPerModule / 2 || moduleRow < 0 || moduleRow >= size) {
+                continue;
+            }
+            for (int col = 0; col < size; ++col) {
+                int x = (col + quietZone) * dotsPerModule + dotsPerModule / 2;
+                for (int channel = 0; channel < LayerCount; ++channel) {
+                    layers[channel].set(moduleRow, col, row[x * 3 + channel] < 128);
+                }
+            }
+        }
+    } else if (model == QrColorModel::Cmy) {
+        for (int layer = 0; layer < LayerCount; ++layer) {
+            readHeader(in, "P4", width, height);
+            int size = getSymbolSize(width, height, dotsPerModule, quietZone);
+            if (layer > 0 && size != layers[0].size()) {
+                throw InvalidColorLayerException("Ink separations differ in size");
+            }
+            layers.push_back(QrModuleMatrix(size));
+            std::vector<unsigned char> row((width + 7) / 8);
+            for (int y = 0; y < height; ++y) {
+                if (!in.read(reinterpret_cast<char*>(row.data()), row.size())) {
+                    throw InvalidColorLayerException("Ink separation is truncated");
+                }
+                int moduleRow = y / dotsPerModule - quietZone;
+                if (y % dotsPerModule != dotsPerModule / 2 || moduleRow < 0 || moduleRow >= size) {
+                    continue;
+                }
+                for (int col = 0; col < size; ++col) {
+                    int x = (col + quietZone) * dotsPerModule + dotsPerModule / 2;
+                    layers[layer].set(moduleRow, col, (row[x / 8] >> (7 - x % 8)) & 1);
+                }
+            }
+        }
+    } else {
+        throw InvalidColorLayerException("Color images need the Rgb or Cmy color model");
+    }
+    return layers;
+}
+
+/**
+ * Returns the byte offsets where characters of the payload start.
+ * Numeric and alphanumeric payloads can be cut anywhere; byte payloads are UTF-8, and kanji payloads
+ * are Shift JIS, split at the same lead bytes as QrModeValidator::isKanji.
+ *
+ * @param payload The payload.
+ * @param mode The mode of the payload.
+ * @return The character starts in increasing order.
+ */
+std::vector<size_t> QrColorLayers::getCharacterStarts(const std::string& payload, QrMode mode) {
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < payload.length(); ++i) {
+        unsigned char c = static_cast<unsigned char>(payload[i]);
+        if (mode == QrMode::ByteMode && (c & 0xC0) == 0x80) {
+            continue;
+        }
+        starts.push_back(i);
+        if (mode == QrMode::KanjiMode && QrModeValidator::isKanjiLeadByte(c)) {
+            ++i;
+        }
+    }
+    return starts;
+}
+
+/**
+ * Checks that there are LayerCount layers of the same size and the scale is valid.
+ *
+ * @param layers The layers.
+ * @param dotsPerModule Width and height of one module in pixels.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @throws InvalidColorLayerException if the layers or scale are invalid.
+ */
+void QrColorLayers::checkLayers(const std::vector<QrModuleMatrix>& layers, int dotsPerModule, int quietZone) {
+    if (layers.size() != static_cast<size_t>(LayerCount)) {
+        throw InvalidColorLayerException("Color symbols need exactly " + std::to_string(LayerCount) + " layers");
+    }
+    for (const QrModuleMatrix& layer : layers) {
+        if (layer.size() != layers[0].size()) {
+            throw InvalidColorLayerException("Color layers must have the same size");
+        }
+    }
+    if (dotsPerModule < 1 || quietZone < 0) {
+        throw InvalidColorLayerException("Dots per module must be positive and the quiet zone cannot be negative");
+    }
+}
+
+/**
+ * Reads the header of a binary netpbm image, including the single whitespace before the pixels.
+ *
+ * @param in The stream holding the image.
+ * @param magic The expected magic number, "P4" or "P6".
+ * @param width Receives the image width.
+ * @param height Receives the image height.
+ * @throws InvalidColorLayerException if the header is malformed.
+ */
+void QrColorLayers::readHeader(std::istream& in, const std::string& magic, int& width, int& height) {
+    std::string format;
+    int maxValue = 255;
+    in >> format >> width >> height;
+    if (magic == "P6") {
+        in >> maxValue;
+    }
+    if (!in || format != magic || width < 1 || height < 1 || maxValue != 255) {
+        throw InvalidColorLayerException("Color image is not a binary " + magic + " image");
+    }
+    in.get();
+}
+
+/**
+ * Computes the symbol size from the image size.
+ *
+ * @param width The image width in pixels.
+ * @param height The image height in pixels.
+ * @param dotsPerModule Width and height of one module in pixels.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @return The symbol size in modules.
+ * @throws InvalidColorLayerException if the image does not match the scale.
+ */
+int QrColorLayers::getSymbolSize(int width, int height, int dotsPerModule, int quietZone) {
+    if (width != height || width % dotsPerModule != 0 || width / dotsPerModule <= 2 * quietZone) {
+        throw InvalidColorLayerException("Color image does not match the module scale");
+    }
+    return width / dotsPerModule - 2 * quietZone;
+}
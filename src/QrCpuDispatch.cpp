@@ -0,0 +1,108 @@
+#include "../include/QrCpuDispatch.hpp"
+#include <atomic>
+
+/**
+ * Constructs an UnsupportedCpuLevelException with a specific error message.
+ *
+ * @param message The error message describing the unsupported level.
+ */
+UnsupportedCpuLevelException::UnsupportedCpuLevelException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+namespace {
+
+const char* const LevelNames[] = {"generic", "sse4.2", "avx2", "avx512"};
+
+/**
+ * Asks the CPU for its features. A level is only reported if the CPU has every instruction set
+ * its variants are compiled for, CPP_QR_ISA_SSE42, CPP_QR_ISA_AVX2 or CPP_QR_ISA_AVX512.
+ */
+QrCpuLevel queryLevel() {
+#ifdef CPP_QR_CPU_VARIANTS
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("sse4.2") || !__builtin_cpu_supports("popcnt")) {
+        return QrCpuLevel::Generic;
+    }
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("bmi") || !__builtin_cpu_supports("bmi2")) {
+        return QrCpuLevel::Sse42;
+    }
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw") || !__builtin_cpu_supports("avx512vl")) {
+        return QrCpuLevel::Avx2;
+    }
+    return QrCpuLevel::Avx512;
+#else
+    return QrCpuLevel::Generic;
+#endif
+}
+
+/// The level used by the kernels; -1 stands for the detected level.
+std::atomic<int> kernelLevel(-1);
+
+}
+
+/**
+ * Detects the highest level supported by both the CPU and the build. The result is cached.
+ *
+ * @return The detected level.
+ */
+QrCpuLevel QrCpuDispatch::detectLevel() {
+    static const QrCpuLevel level = queryLevel();
+    return level;
+}
+
+/**
+ * Checks if kernels of the given level can run on this CPU.
+ *
+ * @param level The level.
+ * @return True if the level is at most the detected one; false otherwise.
+ */
+bool QrCpuDispatch::isSupported(QrCpuLevel level) {
+    return static_cast<int>(level) <= static_cast<int>(detectLevel());
+}
+
+/**
+ * @return The level of the kernel variants used by every dispatched kernel; the detected level until
+ *         setKernelLevel is called.
+ */
+QrCpuLevel QrCpuDispatch::getKernelLevel() {
+    int level = kernelLevel.load();
+    return level < 0 ? detectLevel() : static_cast<QrCpuLevel>(level);
+}
+
+/**
+ * Sets the level of the kernel variants used by every dispatched kernel.
+ *
+ * @param level The level.
+ * @throws UnsupportedCpuLevelException if this CPU cannot run kernels of the level.
+ */
+void QrCpuDispatch::setKernelLevel(QrCpuLevel level) {
+    if (!isSupported(level)) {
+        throw UnsupportedCpuLevelException("This CPU cannot run " + getLevelName(level) + " kernels");
+    }
+    kernelLevel.store(static_cast<int>(level));
+}
+
+/**
+ * @param level The level.
+ * @return The name of the level: "generic", "sse4.2", "avx2" or "avx512".
+ */
+std::string QrCpuDispatch::getLevelName(QrCpuLevel level) {
+    return LevelNames[static_cast<int>(level)];
+}
+
+/**
+ * Parses the name of a level.
+ *
+ * @param name The name as returned by getLevelName.
+ * @param level Receives the level.
+ * @return True if the name is known; false otherwise.
+ */
+bool QrCpuDispatch::parseLevelName(const std::string& name, QrCpuLevel& level) {
+    for (int i = 0; i < 4; ++i) {
+        if (name == LevelNames[i]) {
+            level = static_cast<QrCpuLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,464 @@
+#include "../include/QrFileBatchWriter.hpp"
+#include "../include/QrParallel.hpp"
+#include "../include/QrRowRenderer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef CPP_QR_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+/**
+ * Constructs a QrFileWriteException with a specific error message.
+ *
+ * @param message The error message describing the failed write.
+ */
+QrFileWriteException::QrFileWriteException(const std::string& message)
+    : std::runtime_error(message) {}
+
+namespace {
+
+/**
+ * Writes the files of a batch one after another.
+ */
+class PosixBatchWriter : public QrFileBatchWriter {
+public:
+    explicit PosixBatchWriter(const QrFileBatchOptions& options)
+        : QrFileBatchWriter(options) {}
+
+    ~PosixBatchWriter() override {
+        flushQuietly();
+    }
+
+protected:
+    void writeBatch(const std::vector<Entry>& entries, const unsigned char* data) override {
+        for (const Entry& entry : entries) {
+            writeFile(entry.path, data + entry.offset, entry.size);
+        }
+    }
+};
+
+/**
+ * Spreads the files of a batch over the threads of the QrParallel pool, which lives as long as the process,
+ * so a batch only wakes the threads instead of starting them. The calling thread writes files too.
+ */
+class ThreadPoolBatchWriter : public QrFileBatchWriter {
+public:
+    explicit ThreadPoolBatchWriter(const QrFileBatchOptions& options)
+        : QrFileBatchWriter(options) {}
+
+    ~ThreadPoolBatchWriter() override {
+        flushQuietly();
+    }
+
+protected:
+    void writeBatch(const std::vector<Entry>& entries, const unsigned char* data) override {
+        // forEach reports the failure of the first file, independent of thread scheduling
+        QrParallel::forEach(entries.size(), options.threadCount, [&](size_t i) {
+            writeFile(entries[i].path, data + entries[i].offset, entries[i].size);
+        });
+    }
+};
+
+#ifdef CPP_QR_HAVE_LIBURING
+
+/**
+ * Submits every file of a batch as linked open, write and close requests on direct descriptors.
+ * The batch buffer is registered once, so writes do not map user pages per request.
+ * A failed or short write cancels the linked close, so such files are finished by further rounds
+ * which write the rest of the content or close the slot explicitly. If submitting or reaping fails,
+ * the requests in flight are drained before the error is reported, since they still use the batch
+ * buffer and the slots.
+ */
+class IoUringBatchWriter : public QrFileBatchWriter {
+public:
+    explicit IoUringBatchWriter(const QrFileBatchOptions& options)
+        : QrFileBatchWriter(options), slots(options.queueDepth / 3), inFlight(0), registeredBuffer(false), broken(false) {
+        int result = io_uring_queue_init(options.queueDepth, &ring, 0);
+        if (result < 0) {
+            throw QrFileWriteException(std::string("Cannot create io_uring: ") + std::strerror(-result));
+        }
+        result = io_uring_register_files_sparse(&ring, slots);
+        if (result < 0) {
+            io_uring_queue_exit(&ring);
+            throw QrFileWriteException(std::string("Cannot register io_uring file slots: ") + std::strerror(-result));
+        }
+        // Registration can fail on a low memlock limit; plain writes still work then
+        iovec vector = {buffer.data(), buffer.size()};
+        registeredBuffer = io_uring_register_buffers(&ring, &vector, 1) == 0;
+    }
+
+    ~IoUringBatchWriter() override {
+        flushQuietly();
+        io_uring_queue_exit(&ring);
+    }
+
+protected:
+    void writeBatch(const std::vector<Entry>& entries, const unsigned char* data) override {
+        if (broken) {
+            throw QrFileWriteException("The io_uring of the writer could not be drained after a failure");
+        }
+        try {
+            writeRounds(entries, data);
+        } catch (...) {
+            drain();
+            throw;
+        }
+    }
+
+private:
+    /**
+     * Progress of one file of a round.
+     */
+    struct FileState {
+        bool opened = false;    ///< The file is open in its slot.
+        bool closed = false;    ///< The slot was closed.
+        bool failed = false;    ///< A request of the file failed; the rest of its content is not written.
+        size_t written = 0;     ///< Bytes of the content written so far.
+    };
+
+    /**
+     * Writes the files of a batch in rounds of at most one file per slot.
+     */
+    void writeRounds(const std::vector<Entry>& entries, const unsigned char* data) {
+        std::string error;
+        for (size_t first = 0; first < entries.size(); first += slots) {
+            size_t count = std::min<size_t>(slots, entries.size() - first);
+            std::vector<FileState> files(count);
+            unsigned int submitted = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const Entry& entry = entries[first + i];
+                io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+                io_uring_prep_openat_direct(sqe, AT_FDCWD, entry.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644,
+                                            static_cast<unsigned int>(i));
+                sqe->flags |= IOSQE_IO_LINK;
+                io_uring_sqe_set_data64(sqe, i * 3);
+                submitted += 1 + prepareFinish(entry, data, i, 0);
+            }
+
+            // Every round reaps all its completions before the next one, so the slots are free after the last round
+            while (submitted > 0) {
+                reap(entries, first, files, submitted, error);
+                submitted = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    FileState& file = files[i];
+                    if (file.closed && !file.failed && file.written < entries[first + i].size) {
+                        file.failed = true;
+                        if (error.empty()) {
+                            error = "Cannot write file \"" + entries[first + i].path + "\": short write";
+                        }
+                    }
+                    if (!file.opened || file.closed) {
+                        continue;
+                    }
+                    bool resume = !file.failed && file.written < entries[first + i].size;
+                    submitted += prepareFinish(entries[first + i], data, i, resume ? file.written : entries[first + i].size);
+                }
+            }
+        }
+        if (!error.empty()) {
+            throw QrFileWriteException(error);
+        }
+    }
+
+    /**
+     * Queues the write of the content from the given offset, linked to the close of the slot.
+     * Only the close is queued if nothing is left to write.
+     *
+     * @return The number of queued requests.
+     */
+    unsigned int prepareFinish(const Entry& entry, const unsigned char* data, size_t slot, size_t offset) {
+        unsigned int queued = 0;
+        io_uring_sqe* sqe = nullptr;
+        if (offset < entry.size) {
+            sqe = io_uring_get_sqe(&ring);
+            const unsigned char* content = data + entry.offset + offset;
+            unsigned int length = static_cast<unsigned int>(entry.size - offset);
+            if (registeredBuffer) {
+                io_uring_prep_write_fixed(sqe, static_cast<int>(slot), content, length, offset, 0);
+            } else {
+                io_uring_prep_write(sqe, static_cast<int>(slot), content, length, offset);
+            }
+            sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+            io_uring_sqe_set_data64(sqe, slot * 3 + 1);
+            ++queued;
+        }
+
+        sqe = io_uring_get_sqe(&ring);
+        io_uring_prep_close_direct(sqe, static_cast<unsigned int>(slot));
+        io_uring_sqe_set_data64(sqe, slot * 3 + 2);
+        return queued + 1;
+    }
+
+    /**
+     * Submits the queued requests and reaps their completions, remembering the first failure.
+     */
+    void reap(const std::vector<Entry>& entries, size_t first, std::vector<FileState>& files, unsigned int count, std::string& error) {
+        int result = io_uring_submit_and_wait(&ring, count);
+        if (result < 0) {
+            throw QrFileWriteException(std::string("Cannot submit io_uring requests: ") + std::strerror(-result));
+        }
+        inFlight += static_cast<unsigned int>(result);
+        if (static_cast<unsigned int>(result) < count) {
+            throw QrFileWriteException("Cannot submit all io_uring requests");
+        }
+
+        for (unsigned int i = 0; i < count; ++i) {
+            io_uring_cqe* cqe = nullptr;
+            do {
+                result = io_uring_wait_cqe(&ring, &cqe);
+            } while (result == -EINTR);
+            if (result < 0) {
+                throw QrFileWriteException(std::string("Cannot wait for io_uring completion: ") + std::strerror(-result));
+            }
+            uint64_t request = io_uring_cqe_get_data64(cqe);
+            int res = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+            --inFlight;
+
+            FileState& file = files[request / 3];
+            const Entry& entry = entries[first + request / 3];
+            const char* reason = nullptr;
+            switch (request % 3) {
+            case 0:
+                file.opened = res >= 0;
+                reason = res < 0 ? std::strerror(-res) : nullptr;
+                break;
+            case 1:
+                if (res > 0) {
+                    file.written += static_cast<size_t>(res);
+                } else if (res == 0 && entry.size > 0) {
+                    reason = "no progress";
+                } else if (res < 0 && res != -ECANCELED) {
+                    reason = std::strerror(-res);
+                }
+                break;
+            default:
+                // A close cancelled by a short or failed write is retried by the next round
+                file.closed = res != -ECANCELED;
+                if (res < 0 && res != -ECANCELED && file.opened) {
+                    reason = std::strerror(-res);
+                }
+                break;
+            }
+            if (reason != nullptr) {
+                file.failed = true;
+                if (error.empty()) {
+                    error = "Cannot write file \"" + entry.path + "\": " + reason;
+                }
+            }
+        }
+    }
+
+    /**
+     * Submits the requests still queued after a failure and waits for all requests in flight, ignoring their
+     * results. A ring which cannot be drained is not used again.
+     */
+    void drain() {
+        int result = io_uring_submit(&ring);
+        if (result > 0) {
+            inFlight += static_cast<unsigned int>(result);
+        }
+        broken = result < 0;
+        while (inFlight > 0) {
+            io_uring_cqe* cqe = nullptr;
+            result = io_uring_wait_cqe(&ring, &cqe);
+            if (result == -EINTR) {
+                continue;
+            }
+            if (result < 0) {
+                broken = true;
+                return;
+            }
+            io_uring_cqe_seen(&ring, cqe);
+            --inFlight;
+        }
+    }
+
+    io_uring ring;
+    unsigned int slots;         ///< Number of direct descriptor slots, files in flight at once.
+    unsigned int inFlight;      ///< Submitted requests whose completion was not reaped yet.
+    bool registeredBuffer;      ///< Whether the batch buffer is registered with the ring.
+    bool broken;                ///< Requests may still be in flight after a failed drain.
+};
+
+#endif
+
+}
+
+/**
+ * Creates a writer using the given backend.
+ *
+ * @param backend The backend.
+ * @param options The batch options.
+ * @return The writer.
+ * @throws QrFileWriteException if the backend is not available or cannot be set up.
+ */
+std::unique_ptr<QrFileBatchWriter> QrFileBatchWriter::create(QrFileBackend backend, const QrFileBatchOptions& options) {
+    if (options.batchBytes < 1 || options.threadCount < 1 || options.queueDepth < 3) {
+        throw QrFileWriteException("Batch size, thread count and queue depth are too small");
+    }
+    if (!isAvailable(backend)) {
+        throw QrFileWriteException("The io_uring backend was not built; liburing was not found");
+    }
+
+    switch (backend) {
+    case QrFileBackend::ThreadPool:
+        return std::unique_ptr<QrFileBatchWriter>(new ThreadPoolBatchWriter(options));
+#ifdef CPP_QR_HAVE_LIBURING
+    case QrFileBackend::IoUring:
+        return std::unique_ptr<QrFileBatchWriter>(new IoUringBatchWriter(options));
+#endif
+    default:
+        return std::unique_ptr<QrFileBatchWriter>(new PosixBatchWriter(options));
+    }
+}
+
+/**
+ * Checks if a backend was built into the library.
+ *
+ * @param backend The backend.
+ * @return True if create accepts the backend; false otherwise.
+ */
+bool QrFileBatchWriter::isAvailable(QrFileBackend backend) {
+#ifdef CPP_QR_HAVE_LIBURING
+    (void)backend;
+    return true;
+#else
+    return backend != QrFileBackend::IoUring;
+#endif
+}
+
+/**
+ * Creates a writer with a batch buffer of the given size.
+ *
+ * @param options The batch options.
+ */
+QrFileBatchWriter::QrFileBatchWriter(const QrFileBatchOptions& options)
+    : options(options), buffer(options.batchBytes), used(0), reserved(0), fileCount(0) {}
+
+/**
+ * Destroys the writer.
+ */
+QrFileBatchWriter::~QrFileBatchWriter() {}
+
+/**
+ * Reserves space for the next file in the batch buffer, writing the current batch first if it is full.
+ *
+ * @param size The size of the file in bytes.
+ * @return The buffer to fill, valid until commit.
+ * @throws QrFileWriteException if the file is larger than the batch buffer or a batch cannot be written.
+ */
+unsigned char* QrFileBatchWriter::reserve(size_t size) {
+    if (size > buffer.size()) {
+        throw QrFileWriteException("File of " + std::to_string(size) + " bytes does not fit in the batch buffer");
+    }
+    if (used + size > buffer.size()) {
+        flush();
+    }
+    reserved = size;
+    return buffer.data() + used;
+}
+
+/**
+ * Adds the file filled through the last reserve call to the batch.
+ *
+ * @param path The path of the file, created or truncated.
+ */
+void QrFileBatchWriter::commit(const std::string& path) {
+    Entry entry = {path, used, reserved};
+    entries.push_back(entry);
+    used += reserved;
+    reserved = 0;
+}
+
+/**
+ * Renders a matrix as a binary PBM (P4) image straight into the batch buffer and adds it to the batch.
+ *
+ * @param path The path of the image file.
+ * @param matrix The modules to render.
+ * @param dotsPerModule Width and height of one module in pixels.
+ * @param quietZone Width of the light border around the symbol in modules.
+ */
+void QrFileBatchWriter::writePbm(const std::string& path, const QrModuleMatrix& matrix, int dotsPerModule, int quietZone) {
+    QrRowRenderer renderer(matrix, dotsPerModule, quietZone);
+    std::string header = "P4\n" + std::to_string(renderer.size()) + ' ' + std::to_string(renderer.size()) + '\n';
+    size_t size = header.size() + static_cast<size_t>(renderer.bytesPerRow()) * renderer.size();
+
+    unsigned char* data = reserve(size);
+    std::memcpy(data, header.data(), header.size());
+    data += header.size();
+    while (const unsigned char* row = renderer.nextRow()) {
+        std::memcpy(data, row, renderer.bytesPerRow());
+        data += renderer.bytesPerRow();
+    }
+    commit(path);
+}
+
+/**
+ * Writes all files of the batch and waits for them.
+ *
+ * @throws QrFileWriteException if a file cannot be written; the batch is dropped.
+ */
+void QrFileBatchWriter::flush() {
+    if (entries.empty()) {
+        return;
+    }
+    std::vector<Entry> batch;
+    batch.swap(entries);
+    used = 0;
+    writeBatch(batch, buffer.data());
+    fileCount += batch.size();
+}
+
+/**
+ * @return The number of files written so far.
+ */
+uint64_t QrFileBatchWriter::getFileCount() const {
+    return fileCount;
+}
+
+/**
+ * Writes the remaining files, ignoring errors.
+ */
+void QrFileBatchWriter::flushQuietly() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Destructors cannot report errors
+    }
+}
+
+/**
+ * Writes one file with open, write and close, retrying interrupted and partial writes.
+ *
+ * @param path The path of the file.
+ * @param data The content.
+ * @param size The size of the content.
+ * @throws QrFileWriteException if the file cannot be written.
+ */
+void QrFileBatchWriter::writeFile(const std::string& path, const unsigned char* data, size_t size) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw QrFileWriteException("Cannot create file \"" + path + "\": " + std::strerror(errno));
+    }
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0) {
+            int error = errno;
+            ::close(fd);
+            throw QrFileWriteException("Cannot write file \"" + path + "\": " + std::strerror(error));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    if (::close(fd) != 0) {
+        throw QrFileWriteException("Cannot close file \"" + path + "\": " + std::strerror(errno));
+    }
+}
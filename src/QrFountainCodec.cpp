@@ -0,0 +1,467 @@
+#include "../include/QrFountainCodec.hpp"
+#include "../include/QrParallel.hpp"
+#include <algorithm>
+
+namespace {
+
+const char Base45Alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+
+/**
+ * Encodes bytes in Base45 (RFC 9285): every two bytes become three characters, a final byte two.
+ */
+std::string toBase45(const std::vector<uint8_t>& bytes) {
+    std::string text;
+    text.reserve((bytes.size() + 1) / 2 * 3);
+    for (size_t i = 0; i < bytes.size(); i += 2) {
+        if (i + 1 < bytes.size()) {
+            unsigned int value = bytes[i] * 256u + bytes[i + 1];
+            text += Base45Alphabet[value % 45];
+            text += Base45Alphabet[value / 45 % 45];
+            text += Base45Alphabet[value / 2025];
+        } else {
+            text += Base45Alphabet[bytes[i] % 45];
+            text += Base45Alphabet[bytes[i] / 45];
+        }
+    }
+    return text;
+}
+
+/**
+ * Decodes Base45 (RFC 9285) text.
+ *
+ * @throws InvalidFountainDataException if the text is not valid Base45.
+ */
+std::vector<uint8_t> fromBase45(const std::string& text) {
+    if (text.length() % 3 == 1) {
+        throw InvalidFountainDataException("Base45 text has an invalid length");
+    }
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(text.length() / 3 * 2 + 1);
+    unsigned int digits[3];
+    for (size_t i = 0; i < text.length(); i += 3) {
+        size_t count = std::min<size_t>(3, text.length() - i);
+        for (size_t j = 0; j < count; ++j) {
+            const char* position = std::find(Base45Alphabet, Base45Alphabet + 45, text[i + j]);
+            if (position == Base45Alphabet + 45) {
+                throw InvalidFountainDataException("Base45 text contains an invalid character");
+            }
+            digits[j] = static_cast<unsigned int>(position - Base45Alphabet);
+        }
+        if (count == 3) {
+            unsigned int value = digits[0] + digits[1] * 45 + digits[2] * 2025;
+            if (value > 0xFFFF) {
+                throw InvalidFountainDataException("Base45 text contains an invalid triplet");
+            }
+            bytes.push_back(static_cast<uint8_t>(value >> 8));
+            bytes.push_back(static_cast<uint8_t>(value));
+        } else {
+            unsigned int value = digits[0] + digits[1] * 45;
+            if (value > 0xFF) {
+                throw InvalidFountainDataException("Base45 text contains an invalid pair");
+            }
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+    }
+    return bytes;
+}
+
+/**
+ * Computes the CRC-32 (IEEE 802.3) of the data.
+ */
+uint32_t getCrc32(const std::string& data) {
+    static uint32_t table[256];
+    static bool tableBuilt = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        return true;
+    }();
+    (void)tableBuilt;
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : data) {
+        crc = table[(crc ^ c) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void writeUint(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint32_t readUint(const std::vector<uint8_t>& in, size_t offset, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | in[offset + i];
+    }
+    return value;
+}
+
+/**
+ * SplitMix64 generator. Encoder and decoder must draw identical numbers,
+ * so the standard distributions, whose output is implementation defined, are not used.
+ */
+uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// Fixed point scale of the logarithms and square roots below.
+const int FixedBits = 16;
+const uint64_t FixedOne = 1ULL << FixedBits;
+
+/**
+ * Computes the integer square root of a value.
+ */
+uint64_t getSquareRoot(uint64_t value) {
+    uint64_t root = 0;
+    for (uint64_t bit = 1ULL << 62; bit != 0; bit >>= 2) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+    }
+    return root;
+}
+
+/**
+ * Computes the natural logarithm of a fixed point value of at least one, in fixed point.
+ * The binary logarithm is found bit by bit by repeated squaring, using integers only.
+ */
+uint64_t getLogarithm(uint64_t value) {
+    const uint64_t Ln2 = 45426;     // ln(2) in fixed point
+    int exponent = 63;
+    while ((value >> exponent) == 0) {
+        --exponent;
+    }
+
+    // Normalize to [1, 2) with 30 fraction bits, so squares fit in 64 bits
+    uint64_t mantissa = exponent >= 30 ? value >> (exponent - 30) : value << (30 - exponent);
+    uint64_t log2 = static_cast<uint64_t>(exponent - FixedBits) << FixedBits;
+    for (uint64_t bit = FixedOne >> 1; bit != 0; bit >>= 1) {
+        mantissa = (mantissa * mantissa) >> 30;
+        if (mantissa >= (2ULL << 30)) {
+            mantissa >>= 1;
+            log2 |= bit;
+        }
+    }
+    return (log2 * Ln2) >> FixedBits;
+}
+
+/**
+ * Computes the cumulative robust soliton distribution over degrees 1 ... blockCount (c = 0.1, delta = 0.5).
+ * Encoder and decoder must draw identical degrees on every platform, so the distribution is computed with
+ * integers only: entry d - 1 is the weight of degrees up to d in units of 2^-32.
+ */
+std::vector<uint64_t> getDegreeDistribution(size_t blockCount) {
+    const uint64_t Scale = 1ULL << 32;
+    uint64_t k = blockCount;
+
+    // R = c * ln(k / delta) * sqrt(k) in fixed point; it is positive for every k >= 1
+    uint64_t r = getLogarithm(2 * k * FixedOne) * getSquareRoot(k << (2 * FixedBits)) / FixedOne / 10;
+    uint64_t spike = std::max<uint64_t>(1, std::min<uint64_t>(k, k * FixedOne / r));
+    // R * ln(R / delta) / k, or nothing where the logarithm would be negative
+    uint64_t spikeWeight = 2 * r > FixedOne ? r * getLogarithm(2 * r) / k : 0;
+
+    std::vector<uint64_t> distribution(blockCount);
+    uint64_t total = 0;
+    for (uint64_t d = 1; d <= k; ++d) {
+        uint64_t weight = d == 1 ? Scale / k : Scale / (d * (d - 1));
+        if (d < spike) {
+            weight += (r << (32 - FixedBits)) / (d * k);
+        } else if (d == spike) {
+            weight += spikeWeight;
+        }
+        total += weight;
+        distribution[d - 1] = total;
+    }
+    return distribution;
+}
+
+/**
+ * Returns the blocks mixed into a frame. Frames below the block count carry their own block.
+ */
+std::vector<uint32_t> getFrameBlocks(uint32_t index, uint32_t checksum, size_t blockCount, const std::vector<uint64_t>& distribution) {
+    std::vector<uint32_t> blocks;
+    if (index < blockCount) {
+        blocks.push_back(index);
+        return blocks;
+    }
+
+    uint64_t state = (static_cast<uint64_t>(checksum) << 32) | index;
+    uint64_t draw = nextRandom(state) % distribution.back();
+    size_t degree = std::upper_bound(distribution.begin(), distribution.end(), draw) - distribution.begin() + 1;
+    degree = std::min(degree, blockCount);
+
+    while (blocks.size() < degree) {
+        uint32_t block = static_cast<uint32_t>(nextRandom(state) % blockCount);
+        if (std::find(blocks.begin(), blocks.end(), block) == blocks.end()) {
+            blocks.push_back(block);
+        }
+    }
+    return blocks;
+}
+
+}
+
+/**
+ * Constructs an InvalidFountainDataException with a specific error message.
+ *
+ * @param message The error message describing the invalid data.
+ */
+InvalidFountainDataException::InvalidFountainDataException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+/**
+ * Computes the largest block size whose frames fit in the given version.
+ * Base45 needs three characters for two bytes and two characters for a final single byte.
+ *
+ * @param version The version of the frame symbols.
+ * @param level The error correction level of the frame symbols.
+ * @return The block size in bytes.
+ * @throws InvalidFountainDataException if the version is too small to hold any frame.
+ * @throws InvalidVersionException if the version is outside of 1-40.
+ */
+size_t QrFountainEncoder::getBlockSize(int version, QrErrorCorrectionLevel level) {
+    size_t characters = QrVersionSelector::getDataCapacity(version, level, QrMode::AlphanumericMode);
+    size_t bytes = characters / 3 * 2 + (characters % 3 == 2 ? 1 : 0);
+    if (bytes <= HeaderSize) {
+        throw InvalidFountainDataException("Version " + std::to_string(version) + " is too small for fountain frames");
+    }
+    return std::min<size_t>(bytes - HeaderSize, 0xFFFF);
+}
+
+/**
+ * Computes the number of blocks a payload is split into.
+ *
+ * @param payloadLength The length of the payload in bytes.
+ * @param blockSize The block size in bytes.
+ * @return The number of blocks.
+ */
+size_t QrFountainEncoder::getBlockCount(size_t payloadLength, size_t blockSize) {
+    return (payloadLength + blockSize - 1) / blockSize;
+}
+
+/**
+ * Builds frames firstIndex ... firstIndex + frameCount - 1 of the sequence of a payload.
+ * Every frame is built and sized by its own task.
+ *
+ * @param payload The payload, any bytes.
+ * @param blockSize The block size in bytes (1-65535).
+ * @param firstIndex Index of the first frame to build.
+ * @param frameCount Number of frames to build.
+ * @param options The encode options holding the error correction level and thread budget.
+ * @return The frames in index order.
+ */
+std::vector<QrFountainFrame> QrFountainEncoder::encodeFrames(const std::string& payload, size_t blockSize, uint32_t firstIndex,
+                                                             size_t frameCount, const QrEncodeOptions& options) {
+    if (payload.empty()) {
+        throw EmptyInputMessageException("Encoded message cannot be empty");
+    }
+    if (blockSize < 1 || blockSize > 0xFFFF) {
+        throw InvalidFountainDataException("Block size must be between 1 and 65535 bytes");
+    }
+    size_t blockCount = getBlockCount(payload.length(), blockSize);
+    if (payload.length() > MaxPayloadLength || blockCount > MaxBlockCount) {
+        throw InvalidFountainDataException("Payload is too long for a fountain sequence of this block size");
+    }
+    uint32_t checksum = getCrc32(payload);
+    std::vector<uint64_t> distribution = getDegreeDistribution(blockCount);
+
+    std::vector<QrFountainFrame> frames(frameCount);
+    QrParallel::forEach(frameCount, options.threadBudget, [&](size_t i) {
+        uint32_t index = firstIndex + static_cast<uint32_t>(i);
+        std::vector<uint8_t> bytes;
+        bytes.reserve(HeaderSize + blockSize);
+        writeUint(bytes, static_cast<uint32_t>(payload.length()), 4);
+        writeUint(bytes, static_cast<uint32_t>(blockSize), 2);
+        writeUint(bytes, checksum, 4);
+        writeUint(bytes, index, 4);
+        bytes.resize(HeaderSize + blockSize, 0);
+
+        // The last block is padded with zeros
+        for (uint32_t block : getFrameBlocks(index, checksum, blockCount, distribution)) {
+            size_t begin = block * blockSize;
+            size_t end = std::min(begin + blockSize, payload.length());
+            for (size_t j = begin; j < end; ++j) {
+                bytes[HeaderSize + j - begin] ^= static_cast<uint8_t>(payload[j]);
+            }
+        }
+
+        QrFountainFrame& frame = frames[i];
+        frame.index = index;
+        frame.text = toBase45(bytes);
+        frame.mode = QrModeSelector::getQrMode(frame.text);
+        frame.version = QrVersionSelector::getQrVersion(frame.text, options.level, frame.mode);
+    });
+    return frames;
+}
+
+/**
+ * Creates a decoder which accepts the first sequence it receives a frame of.
+ */
+QrFountainDecoder::QrFountainDecoder()
+    : payloadLength(0), blockSize(0), checksum(0), decodedCount(0) {}
+
+/**
+ * Adds a received frame. Blocks decoded earlier are removed from the frame right away;
+ * a frame left with one block decodes it, and that block is then peeled off the pending frames.
+ *
+ * @param text The text read from the symbol.
+ * @return True if the frame was new; false if a frame with the same index was added before.
+ * @throws InvalidFountainDataException if the frame is malformed or belongs to another sequence.
+ */
+bool QrFountainDecoder::addFrame(const std::string& text) {
+    std::vector<uint8_t> bytes = fromBase45(text);
+    if (bytes.size() <= QrFountainEncoder::HeaderSize) {
+        throw InvalidFountainDataException("Fountain frame is too short");
+    }
+
+    uint32_t frameLength = readUint(bytes, 0, 4);
+    size_t frameBlockSize = readUint(bytes, 4, 2);
+    uint32_t frameChecksum = readUint(bytes, 6, 4);
+    uint32_t index = readUint(bytes, 10, 4);
+    if (frameLength == 0 || frameBlockSize == 0 || bytes.size() != QrFountainEncoder::HeaderSize + frameBlockSize) {
+        throw InvalidFountainDataException("Fountain frame header is inconsistent");
+    }
+    // The header is not protected by the CRC, so a forged one must not size the decoder state
+    if (frameLength > QrFountainEncoder::MaxPayloadLength ||
+        QrFountainEncoder::getBlockCount(frameLength, frameBlockSize) > QrFountainEncoder::MaxBlockCount) {
+        throw InvalidFountainDataException("Fountain frame header announces a too long payload");
+    }
+
+    if (blockSize == 0) {
+        payloadLength = frameLength;
+        blockSize = frameBlockSize;
+        checksum = frameChecksum;
+        size_t blockCount = QrFountainEncoder::getBlockCount(payloadLength, blockSize);
+        degreeDistribution = getDegreeDistribution(blockCount);
+        blocks.assign(blockCount, std::vector<uint8_t>());
+        decoded.assign(blockCount, false);
+        blockFrames.assign(blockCount, std::vector<size_t>());
+    } else if (frameLength != payloadLength || frameBlockSize != blockSize || frameChecksum != checksum) {
+        throw InvalidFountainDataException("Fountain frame belongs to another sequence");
+    }
+
+    if (!seenFrames.insert(index).second) {
+        return false;
+    }
+
+    PendingFrame frame;
+    frame.data.assign(bytes.begin() + QrFountainEncoder::HeaderSize, bytes.end());
+    for (uint32_t block : getFrameBlocks(index, checksum, blocks.size(), degreeDistribution)) {
+        if (!decoded[block]) {
+            frame.blocks.push_back(block);
+            continue;
+        }
+        for (size_t j = 0; j < blockSize; ++j) {
+            frame.data[j] ^= blocks[block][j];
+        }
+    }
+
+    if (frame.blocks.size() == 1) {
+        resolveBlock(frame.blocks[0], frame.data);
+    } else if (frame.blocks.size() > 1) {
+        for (uint32_t block : frame.blocks) {
+            blockFrames[block].push_back(pendingFrames.size());
+        }
+        pendingFrames.push_back(frame);
+    }
+    return true;
+}
+
+/**
+ * @return True if all blocks of the payload were decoded; false otherwise.
+ */
+bool QrFountainDecoder::isComplete() const {
+    return blockSize != 0 && decodedCount == blocks.size();
+}
+
+/**
+ * @return The number of blocks of the sequence, or 0 before the first frame.
+ */
+size_t QrFountainDecoder::getBlockCount() const {
+    return blocks.size();
+}
+
+/**
+ * @return The number of blocks decoded so far.
+ */
+size_t QrFountainDecoder::getDecodedBlockCount() const {
+    return decodedCount;
+}
+
+/**
+ * Returns the decoded payload.
+ *
+ * @return The payload.
+ * @throws InvalidFountainDataException if the payload is not complete or fails the CRC check.
+ */
+std::string QrFountainDecoder::getPayload() const {
+    if (!isComplete()) {
+        throw InvalidFountainDataException("Fountain sequence is not complete");
+    }
+
+    std::string payload;
+    payload.reserve(blocks.size() * blockSize);
+    for (const std::vector<uint8_t>& block : blocks) {
+        payload.append(block.begin(), block.end());
+    }
+    payload.resize(payloadLength);
+    if (getCrc32(payload) != checksum) {
+        throw InvalidFountainDataException("Fountain payload fails the CRC check");
+    }
+    return payload;
+}
+
+/**
+ * Stores a decoded block and peels it off all pending frames, decoding the blocks this uncovers.
+ *
+ * @param block The decoded block.
+ * @param data The content of the block.
+ */
+void QrFountainDecoder::resolveBlock(uint32_t block, std::vector<uint8_t> data) {
+    std::vector<std::pair<uint32_t, std::vector<uint8_t>>> ready;
+    ready.push_back(std::make_pair(block, std::move(data)));
+
+    while (!ready.empty()) {
+        uint32_t current = ready.back().first;
+        std::vector<uint8_t> content = std::move(ready.back().second);
+        ready.pop_back();
+        if (decoded[current]) {
+            continue;
+        }
+        decoded[current] = true;
+        ++decodedCount;
+
+        for (size_t frameIndex : blockFrames[current]) {
+            PendingFrame& frame = pendingFrames[frameIndex];
+            std::vector<uint32_t>::iterator position = std::find(frame.blocks.begin(), frame.blocks.end(), current);
+            if (position == frame.blocks.end()) {
+                continue;
+            }
+            frame.blocks.erase(position);
+            for (size_t j = 0; j < blockSize; ++j) {
+                frame.data[j] ^= content[j];
+            }
+            if (frame.blocks.size() == 1) {
+                ready.push_back(std::make_pair(frame.blocks[0], frame.data));
+                frame.blocks.clear();
+                std::vector<uint8_t>().swap(frame.data);
+            }
+        }
+        std::vector<size_t>().swap(blockFrames[current]);
+        blocks[current] = std::move(content);
+    }
+}
@@ -0,0 +1,306 @@
+#include "../include/QrMaskSelector.hpp"
+#include "../include/QrParallel.hpp"
+#include <atomic>
+#include <bitset>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+const int QrMaskSelector::MaskCount;
+
+/**
+ * Constructs an InvalidMaskException with a specific error message.
+ *
+ * @param message The error message indicating the invalid mask.
+ */
+InvalidMaskException::InvalidMaskException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+namespace {
+
+/**
+ * Reads one module from the row words of a symbol.
+ */
+inline bool isDark(const uint64_t* const* rows, int row, int col) {
+    return (rows[row][col / 64] >> (col % 64)) & 1;
+}
+
+/**
+ * Scores one line of modules with the run (N1) and finder-like pattern (N3) rules.
+ *
+ * @param rows The words of every row of the masked symbol.
+ * @param size The width of the symbol.
+ * @param index The row or column to score.
+ * @param horizontal True to score a row; false to score a column.
+ * @return The penalty of the line.
+ */
+int scoreLine(const uint64_t* const* rows, int size, int index, bool horizontal) {
+    int score = 0;
+    int runLength = 0;
+    bool runColor = false;
+    unsigned int window = 0;
+
+    for (int i = 0; i < size; ++i) {
+        bool dark = horizontal ? isDark(rows, index, i) : isDark(rows, i, index);
+
+        // N1: five or more modules of the same color in a line
+        if (i > 0 && dark == runColor) {
+            ++runLength;
+        } else {
+            if (runLength >= 5) {
+                score += 3 + (runLength - 5);
+            }
+            runColor = dark;
+            runLength = 1;
+        }
+
+        // N3: 1:1:3:1:1 finder-like pattern with four light modules on either side
+        window = ((window << 1) | (dark ? 1 : 0)) & 0x7FF;
+        if (i >= 10 && (window == 0x5D0 || window == 0x05D)) {
+            score += 40;
+        }
+    }
+    if (runLength >= 5) {
+        score += 3 + (runLength - 5);
+    }
+
+    return score;
+}
+
+/**
+ * Scores the 2x2 blocks (N2 rule) whose top-left module is in the given row.
+ *
+ * @param rows The words of every row of the masked symbol.
+ * @param size The width of the symbol.
+ * @param row The upper row of the blocks.
+ * @return The penalty of the blocks.
+ */
+int scoreBlocks(const uint64_t* const* rows, int size, int row) {
+    int score = 0;
+    for (int col = 0; col + 1 < size; ++col) {
+        bool dark = isDark(rows, row, col);
+        if (isDark(rows, row, col + 1) == dark && isDark(rows, row + 1, col) == dark && isDark(rows, row + 1, col + 1) == dark) {
+            score += 3;
+        }
+    }
+    return score;
+}
+
+/**
+ * Scores the balance of dark and light modules (N4 rule): 10 points for every full 5% away from an even split.
+ *
+ * @param rows The words of every row of the masked symbol.
+ * @param size The width of the symbol.
+ * @param wordsPerRow Number of words of a row.
+ * @return The penalty of the balance.
+ */
+int scoreBalance(const uint64_t* const* rows, int size, int wordsPerRow) {
+    long dark = 0;
+    for (int row = 0; row < size; ++row) {
+        for (int word = 0; word < wordsPerRow; ++word) {
+            dark += static_cast<long>(std::bitset<64>(rows[row][word]).count());
+        }
+    }
+    long total = static_cast<long>(size) * size;
+    return static_cast<int>(std::labs(dark * 100 - total * 50) / (total * 5)) * 10;
+}
+
+}
+
+/**
+ * Checks if the mask pattern inverts the module at the given position.
+ *
+ * @param mask The mask pattern (0-7).
+ * @param row The row of the module.
+ * @param col The column of the module.
+ * @return True if the module is inverted; false otherwise.
+ */
+bool QrMaskSelector::isMasked(int mask, int row, int col) {
+    switch (mask) {
+        case 0: return (row + col) % 2 == 0;
+        case 1: return row % 2 == 0;
+        case 2: return col % 3 == 0;
+        case 3: return (row + col) % 3 == 0;
+        case 4: return (row / 2 + col / 3) % 2 == 0;
+        case 5: return (row * col) % 2 + (row * col) % 3 == 0;
+        case 6: return ((row * col) % 2 + (row * col) % 3) % 2 == 0;
+        case 7: return ((row + col) % 2 + (row * col) % 3) % 2 == 0;
+    }
+    return false;
+}
+
+/**
+ * Inverts every module selected by the mask pattern which is not reserved, one row word at a time.
+ *
+ * @param matrix The symbol to mask.
+ * @param reserved Matrix of the same size whose dark modules mark function patterns.
+ * @param mask The mask pattern (0-7).
+ * @throws InvalidMaskException if the mask is outside of 0-7.
+ */
+void QrMaskSelector::applyMask(QrModuleMatrix& matrix, const QrModuleMatrix& reserved, int mask) {
+    checkMask(mask);
+
+    for (int row = 0; row < matrix.size(); ++row) {
+        uint64_t* rowWords = matrix.rowData(row);
+        const uint64_t* reservedWords = reserved.rowData(row);
+        for (int word = 0; word < matrix.wordsPerRow(); ++word) {
+            uint64_t pattern = 0;
+            int firstCol = word * 64;
+            for (int bit = 0; bit < 64 && firstCol + bit < matrix.size(); ++bit) {
+                if (isMasked(mask, row, firstCol + bit)) {
+                    pattern |= static_cast<uint64_t>(1) << bit;
+                }
+            }
+            rowWords[word] ^= pattern & ~reservedWords[word];
+        }
+    }
+}
+
+/**
+ * Computes the ISO 18004 penalty score of a symbol.
+ *
+ * @param matrix The masked symbol.
+ * @return The sum of the four penalty rules.
+ */
+int QrMaskSelector::getPenalty(const QrModuleMatrix& matrix) {
+    return scorePenalty(matrix, 1, INT_MAX);
+}
+
+/**
+ * Selects the mask pattern for a symbol according to the strategy in the options.
+ * Candidates are dropped as soon as their partial score exceeds the best one, which never changes the result.
+ * The Fixed and Fast strategies skip the full penalty unless measurePenaltyDelta is set.
+ *
+ * @param matrix The unmasked symbol.
+ * @param reserved Matrix of the same size whose dark modules mark function patterns.
+ * @param options The encode options holding the mask strategy.
+ * @return The selected mask and its penalty, if computed.
+ * @throws InvalidMaskException if the fixed mask is outside of 0-7.
+ */
+QrMaskSelection QrMaskSelector::selectMask(const QrModuleMatrix& matrix, const QrModuleMatrix& reserved, const QrEncodeOptions& options) {
+    QrMaskSelection selection;
+    selection.penalty = -1;
+    selection.penaltyDelta = -1;
+    int threadCount = QrParallel::getThreadCount((matrix.size() - 17) / 4, options);
+    int score = 0;
+
+    if (options.maskStrategy == QrMaskStrategy::Fixed) {
+        checkMask(options.fixedMask);
+        selection.mask = options.fixedMask;
+    }
+    else if (options.maskStrategy == QrMaskStrategy::Fast) {
+        selection.mask = findBestMask(matrix, reserved, options.sampleStride > 1 ? options.sampleStride : 1, threadCount, score);
+    }
+    else {
+        // The winner is never cut short, so its score is the full penalty
+        selection.mask = findBestMask(matrix, reserved, 1, threadCount, selection.penalty);
+    }
+
+    if (options.measurePenaltyDelta) {
+        if (options.maskStrategy == QrMaskStrategy::Exhaustive) {
+            selection.penaltyDelta = 0;
+        } else {
+            QrModuleMatrix masked = matrix;
+            applyMask(masked, reserved, selection.mask);
+            selection.penalty = getPenalty(masked);
+            int bestPenalty = 0;
+            findBestMask(matrix, reserved, 1, threadCount, bestPenalty);
+            selection.penaltyDelta = selection.penalty - bestPenalty;
+        }
+    }
+
+    return selection;
+}
+
+/**
+ * Computes the penalty score on every stride-th row and column, scaled back to the whole symbol.
+ * The row words are looked up once, so the rules read modules without calls into the matrix.
+ *
+ * @param matrix The masked symbol.
+ * @param stride Distance between the scored rows and columns.
+ * @param bound Score above which the scoring stops early.
+ * @return The score, or a partial score above the bound.
+ */
+int QrMaskSelector::scorePenalty(const QrModuleMatrix& matrix, int stride, int bound) {
+    int size = matrix.size();
+    std::vector<const uint64_t*> rowWords(size);
+    for (int row = 0; row < size; ++row) {
+        rowWords[row] = matrix.rowData(row);
+    }
+    const uint64_t* const* rows = rowWords.data();
+
+    int score = scoreBalance(rows, size, matrix.wordsPerRow());
+    if (score > bound) {
+        return score;
+    }
+
+    for (int row = 0; row < size; row += stride) {
+        int rowScore = scoreLine(rows, size, row, true);
+        if (row + 1 < size) {
+            rowScore += scoreBlocks(rows, size, row);
+        }
+        score += rowScore * stride;
+        if (score > bound) {
+            return score;
+        }
+    }
+
+    for (int col = 0; col < size; col += stride) {
+        score += scoreLine(rows, size, col, false) * stride;
+        if (score > bound) {
+            return score;
+        }
+    }
+
+    return score;
+}
+
+/**
+ * Selects the mask with the lowest score computed with the given stride.
+ * The best score so far is shared between threads; a candidate is only dropped when its partial score
+ * exceeds it, so the result does not depend on the order in which candidates finish.
+ * Ties are resolved towards the lower mask number.
+ *
+ * @param matrix The unmasked symbol.
+ * @param reserved Matrix of the same size whose dark modules mark function patterns.
+ * @param stride Distance between the scored rows and columns.
+ * @param threadCount Maximum number of threads scoring candidates.
+ * @param score Receives the score of the selected mask.
+ * @return The selected mask.
+ */
+int QrMaskSelector::findBestMask(const QrModuleMatrix& matrix, const QrModuleMatrix& reserved, int stride, int threadCount, int& score) {
+    std::atomic<int> bestScore(INT_MAX);
+    std::vector<int> scores(MaskCount);
+
+    QrParallel::forEach(MaskCount, threadCount, [&](size_t mask) {
+        QrModuleMatrix masked = matrix;
+        applyMask(masked, reserved, static_cast<int>(mask));
+        int maskScore = scorePenalty(masked, stride, bestScore.load());
+        scores[mask] = maskScore;
+
+        int best = bestScore.load();
+        while (maskScore < best && !bestScore.compare_exchange_weak(best, maskScore)) {
+        }
+    });
+
+    int bestMask = 0;
+    for (int mask = 1; mask < MaskCount; ++mask) {
+        if (scores[mask] < scores[bestMask]) {
+            bestMask = mask;
+        }
+    }
+    score = scores[bestMask];
+    return bestMask;
+}
+
+/**
+ * Validates the mask number.
+ *
+ * @param mask The mask pattern.
+ * @throws InvalidMaskException if the mask is outside of 0-7.
+ */
+void QrMaskSelector::checkMask(int mask) {
+    if (mask < 0 || mask >= MaskCount) {
+        throw InvalidMaskException("Mask " + std::to_string(mask) + " is not a valid QR mask pattern");
+    }
+}
@@ -0,0 +1,201 @@
+#include "../include/QrModeAccumulator.hpp"
+
+/**
+ * Appends a chunk of data to the accumulated message.
+ *
+ * @param chunk The bytes to append.
+ */
+void QrModeAccumulator::append(const std::string& chunk) {
+    append(chunk.data(), chunk.size());
+}
+
+/**
+ * Appends a chunk of data, updating the mode eligibility only for the new bytes.
+ *
+ * @param data Pointer to the bytes to append.
+ * @param length Number of bytes to append.
+ */
+void QrModeAccumulator::append(const char* data, size_t length) {
+    buffer.reserve(buffer.size() + length);
+    states.reserve(states.size() + length);
+
+    unsigned char state = currentState();
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (!QrModeValidator::isNumericChar(c)) {
+            ++nonNumericCount;
+        }
+        if (!QrModeValidator::isAlphanumericChar(c)) {
+            ++nonAlphanumericCount;
+        }
+        state = nextState(state, c);
+        buffer.push_back(data[i]);
+        states.push_back(state);
+    }
+}
+
+/**
+ * Removes bytes from the end of the accumulated message.
+ *
+ * @param count Number of bytes to remove.
+ */
+void QrModeAccumulator::pop(size_t count) {
+    truncate(count >= buffer.size() ? 0 : buffer.size() - count);
+}
+
+/**
+ * Shortens the accumulated message, restoring the parser state stored for the new last byte.
+ *
+ * @param length The new length.
+ */
+void QrModeAccumulator::truncate(size_t length) {
+    while (buffer.size() > length) {
+        unsigned char c = static_cast<unsigned char>(buffer.back());
+        if (!QrModeValidator::isNumericChar(c)) {
+            --nonNumericCount;
+        }
+        if (!QrModeValidator::isAlphanumericChar(c)) {
+            --nonAlphanumericCount;
+        }
+        buffer.pop_back();
+        states.pop_back();
+    }
+}
+
+/**
+ * Removes all accumulated data.
+ */
+void QrModeAccumulator::clear() {
+    buffer.clear();
+    states.clear();
+    nonNumericCount = 0;
+    nonAlphanumericCount = 0;
+}
+
+const std::string& QrModeAccumulator::data() const {
+    return buffer;
+}
+
+size_t QrModeAccumulator::length() const {
+    return buffer.size();
+}
+
+bool QrModeAccumulator::empty() const {
+    return buffer.empty();
+}
+
+bool QrModeAccumulator::isNumeric() const {
+    return nonNumericCount == 0;
+}
+
+bool QrModeAccumulator::isAlphanumeric() const {
+    return nonAlphanumericCount == 0;
+}
+
+bool QrModeAccumulator::isByte() const {
+    unsigned char state = currentState();
+    return (state & Utf8Invalid) == 0 && (state & Utf8PendingMask) == 0;
+}
+
+bool QrModeAccumulator::isKanji() const {
+    unsigned char state = currentState();
+    return (state & KanjiInvalid) == 0 && (state & KanjiPending) == 0;
+}
+
+/**
+ * Determines the QR encoding mode for the accumulated message, in the same order as QrModeSelector.
+ *
+ * @return The appropriate QrMode for the accumulated message.
+ * @throws EmptyInputMessageException if no data was accumulated.
+ * @throws InvalidInputMessageException if the message cannot be encoded in any supported QR mode.
+ */
+QrMode QrModeAccumulator::getQrMode() const {
+    if (buffer.empty()) {
+        throw EmptyInputMessageException("Encoded message cannot be empty");
+    }
+
+    if (isNumeric()) {
+        return QrMode::NumericMode;
+    }
+    else if (isAlphanumeric()) {
+        return QrMode::AlphanumericMode;
+    }
+    else if (isByte()) {
+        return QrMode::ByteMode;
+    }
+    else if (isKanji()) {
+        return QrMode::KanjiMode;
+    }
+
+    throw InvalidInputMessageException("Input \"" + buffer + "\" cannot be encoded in any supported QR mode");
+}
+
+/**
+ * Determines the QR version for the accumulated message without rescanning it.
+ *
+ * @param level The error correction level
+ * @return The appropriate version represented as intiger
+ */
+int QrModeAccumulator::getQrVersion(QrErrorCorrectionLevel level) const {
+    return QrVersionSelector::getQrVersion(buffer.size(), level, getQrMode());
+}
+
+/**
+ * Computes the parser state after consuming one more byte.
+ * Mirrors QrModeValidator::isByte and QrModeValidator::isKanji one byte at a time.
+ *
+ * @param state The parser state before the byte.
+ * @param c The consumed byte.
+ * @return The parser state after the byte.
+ */
+unsigned char QrModeAccumulator::nextState(unsigned char state, unsigned char c) {
+    // UTF-8 byte mode
+    if ((state & Utf8Invalid) == 0) {
+        unsigned char pending = state & Utf8PendingMask;
+        state &= ~Utf8PendingMask;
+        if (pending == 0) {
+            if ((c >> 7) == 0) { // 1-byte character
+                pending = 0;
+            } else if ((c >> 5) == 0b110) { // 2-byte character
+                pending = 1;
+            } else if ((c >> 4) == 0b1110) { // 3-byte character
+                pending = 2;
+            } else if ((c >> 3) == 0b11110) { // 4-byte character
+                pending = 3;
+            } else {
+                state |= Utf8Invalid; // Invalid UTF-8 start byte
+            }
+        } else if ((c >> 6) != 0b10) { // Continuation byte
+            state |= Utf8Invalid;
+            pending = 0;
+        } else {
+            pending--;
+        }
+        state |= pending;
+    }
+
+    // Shift JIS kanji mode
+    if ((state & KanjiInvalid) == 0) {
+        if (state & KanjiPending) {
+            state &= ~KanjiPending;
+            if (!(c >= 0x40 && c <= 0xFC && c != 0x7F)) {
+                state |= KanjiInvalid; // Invalid second byte
+            }
+        } else if (c < 0x80 || c >= 0xa0) {
+            // Single-byte character (ASCII or Katakana)
+        } else if (QrModeValidator::isKanjiLeadByte(c)) {
+            state |= KanjiPending;
+        } else {
+            state |= KanjiInvalid; // Invalid byte
+        }
+    }
+
+    return state;
+}
+
+/**
+ * @return The parser state after the last accumulated byte, or the initial state if empty.
+ */
+unsigned char QrModeAccumulator::currentState() const {
+    return states.empty() ? 0 : states.back();
+}
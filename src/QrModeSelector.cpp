@@ -55,7 +55,7 @@ QrMode QrModeSelector::getQrMode(const std::string& input) {
  * @return True if the string is numeric; false otherwise.
  */
 bool QrModeValidator::isNumeric(const std::string& str) {
-    return std::all_of(str.begin(), str.end(), ::isdigit);
+    return std::all_of(str.begin(), str.end(), isNumericChar);
 }
 
 /**
@@ -65,11 +65,29 @@ bool QrModeValidator::isNumeric(const std::string& str) {
  * @return True if the string is alphanumeric; false otherwise.
  */
 bool QrModeValidator::isAlphanumeric(const std::string& str) {
-    return std::all_of(str.begin(), str.end(), [](unsigned char c) {
-        return std::isdigit(c) || (c >= 'A' && c <= 'Z') || std::isspace(c) ||
-               c == '$' || c == '%' || c == '*' || c == '+' || c == '-' || 
-               c == '.' || c == '/' || c == ':';
-    });
+    return std::all_of(str.begin(), str.end(), isAlphanumericChar);
+}
+
+/**
+ * Checks if a single character is a digit (0-9).
+ *
+ * @param c The character to validate as numeric.
+ * @return True if the character is numeric; false otherwise.
+ */
+bool QrModeValidator::isNumericChar(unsigned char c) {
+    return std::isdigit(c);
+}
+
+/**
+ * Checks if a single character is one of 0-9, A-Z, whitespace or allowed symbols.
+ *
+ * @param c The character to validate as alphanumeric.
+ * @return True if the character is alphanumeric; false otherwise.
+ */
+bool QrModeValidator::isAlphanumericChar(unsigned char c) {
+    return std::isdigit(c) || (c >= 'A' && c <= 'Z') || std::isspace(c) ||
+           c == '$' || c == '%' || c == '*' || c == '+' || c == '-' || 
+           c == '.' || c == '/' || c == ':';
 }
 
 /**
@@ -120,7 +138,7 @@ bool QrModeValidator::isKanji(const std::string& str) {
         }
         
         // Multi-byte character
-        if ((c >= 0x81 && c <= 0x9F) || (c >= 0xe0 && c <= 0xef)) {
+        if (isKanjiLeadByte(c)) {
             // Next byte must be in the valid range for multi-byte characters
             if (i + 1 < str.length()) {
                 unsigned char nextByte = static_cast<unsigned char>(str[i + 1]);
@@ -137,3 +155,14 @@ bool QrModeValidator::isKanji(const std::string& str) {
     }
     return true;
 }
+
+/**
+ * Checks if a byte starts a two byte character in a string accepted by isKanji.
+ * Bytes 0xA0-0xFF are read as single byte characters, so only 0x81-0x9F start two byte characters.
+ *
+ * @param c The byte to check.
+ * @return True if the byte is a Shift JIS lead byte; false if it is a character by itself.
+ */
+bool QrModeValidator::isKanjiLeadByte(unsigned char c) {
+    return c >= 0x81 && c <= 0x9F;
+}
@@ -0,0 +1,80 @@
+#include "../include/QrModuleMatrix.hpp"
+#include <string>
+
+/**
+ * Constructs an InvalidVersionException with a specific error message.
+ *
+ * @param message The error message indicating the invalid version.
+ */
+InvalidVersionException::InvalidVersionException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+/**
+ * Constructs a matrix of light modules.
+ *
+ * @param size Width and height of the matrix in modules.
+ */
+QrModuleMatrix::QrModuleMatrix(int size)
+    : matrixSize(size), rowWords((size + 63) / 64), words(static_cast<size_t>(size) * ((size + 63) / 64), 0) {}
+
+/**
+ * Constructs a matrix of light modules sized for the given version.
+ *
+ * @param version The QR version (1-40).
+ * @return The matrix of 17 + 4 * version modules.
+ * @throws InvalidVersionException if the version is outside of 1-40.
+ */
+QrModuleMatrix QrModuleMatrix::fromVersion(int version) {
+    return QrModuleMatrix(sizeForVersion(version));
+}
+
+/**
+ * Returns the width of a symbol of the given version.
+ *
+ * @param version The QR version (1-40).
+ * @return The width in modules.
+ * @throws InvalidVersionException if the version is outside of 1-40.
+ */
+int QrModuleMatrix::sizeForVersion(int version) {
+    if (version < 1 || version > 40) {
+        throw InvalidVersionException("Version " + std::to_string(version) + " is not a valid QR code version");
+    }
+    return 17 + 4 * version;
+}
+
+int QrModuleMatrix::size() const {
+    return matrixSize;
+}
+
+int QrModuleMatrix::wordsPerRow() const {
+    return rowWords;
+}
+
+bool QrModuleMatrix::get(int row, int col) const {
+    return (rowData(row)[col / 64] >> (col % 64)) & 1;
+}
+
+void QrModuleMatrix::set(int row, int col, bool dark) {
+    uint64_t bit = static_cast<uint64_t>(1) << (col % 64);
+    if (dark) {
+        rowData(row)[col / 64] |= bit;
+    } else {
+        rowData(row)[col / 64] &= ~bit;
+    }
+}
+
+const uint64_t* QrModuleMatrix::rowData(int row) const {
+    return &words[static_cast<size_t>(row) * rowWords];
+}
+
+uint64_t* QrModuleMatrix::rowData(int row) {
+    return &words[static_cast<size_t>(row) * rowWords];
+}
+
+bool QrModuleMatrix::operator==(const QrModuleMatrix& other) const {
+    return matrixSize == other.matrixSize && words == other.words;
+}
+
+bool QrModuleMatrix::operator!=(const QrModuleMatrix& other) const {
+    return !(*this == other);
+}
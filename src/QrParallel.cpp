@@ -0,0 +1,200 @@
+#include "../include/QrParallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// The version threshold of options which leave it at 0.
+std::atomic<int> versionThreshold(30);
+
+/**
+ * One forEach call shared between its caller and the pool threads which joined it.
+ */
+struct Job {
+    const std::function<void(size_t)>* task;
+    size_t count;
+    std::atomic<size_t> nextIndex;
+    std::vector<std::exception_ptr> errors;
+    int openSeats;      ///< Pool threads which may still join.
+    int helpers;        ///< Pool threads running tasks of the job.
+
+    /**
+     * Runs the next unclaimed tasks until all are claimed.
+     */
+    void runTasks() {
+        for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+            try {
+                (*task)(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    }
+};
+
+/**
+ * Threads kept for the lifetime of the process, which join the jobs of forEach calls.
+ * The pool grows to the largest thread count requested so far and never shrinks.
+ */
+class WorkerPool {
+public:
+    WorkerPool() : stopping(false) {}
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * Runs the tasks of a job on the calling thread and on the pool threads which are idle meanwhile.
+     * Returns after every task finished.
+     */
+    void run(Job& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            startWorkers(job.openSeats);
+            jobs.push_back(&job);
+        }
+        wake.notify_all();
+        job.runTasks();
+
+        // All tasks are claimed; wait for the pool threads still running one
+        std::unique_lock<std::mutex> lock(mutex);
+        std::deque<Job*>::iterator queued = std::find(jobs.begin(), jobs.end(), &job);
+        if (queued != jobs.end()) {
+            jobs.erase(queued);
+        }
+        done.wait(lock, [&job]() { return job.helpers == 0; });
+    }
+
+private:
+    /**
+     * Starts threads until the pool has the given number. A thread which cannot be started leaves
+     * the pool smaller; the callers run the tasks on the threads there are.
+     */
+    void startWorkers(int count) {
+        while (static_cast<int>(workers.size()) < count) {
+            try {
+                workers.push_back(std::thread(&WorkerPool::work, this));
+            } catch (const std::system_error&) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Joins the queued jobs until the pool stops.
+     */
+    void work() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            Job* job = jobs.front();
+            if (--job->openSeats == 0) {
+                jobs.pop_front();
+            }
+            ++job->helpers;
+            lock.unlock();
+            job->runTasks();
+            lock.lock();
+            if (--job->helpers == 0) {
+                done.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::deque<Job*> jobs;              ///< Jobs with open seats, oldest first.
+    std::mutex mutex;
+    std::condition_variable wake;       ///< Signals a new job or stopping to the pool threads.
+    std::condition_variable done;       ///< Signals that a pool thread left a job.
+    bool stopping;
+};
+
+WorkerPool& getWorkerPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+}
+
+/**
+ * Determines how many threads an encode of the given version may use.
+ *
+ * @param version The version selected by QrVersionSelector::getQrVersion.
+ * @param options The encode options holding the thread budget and version threshold.
+ * @return The number of threads to use.
+ */
+int QrParallel::getThreadCount(int version, const QrEncodeOptions& options) {
+    int threshold = options.parallelVersionThreshold > 0 ? options.parallelVersionThreshold : getVersionThreshold();
+    if (version < threshold || options.threadBudget < 2) {
+        return 1;
+    }
+    return options.threadBudget;
+}
+
+/**
+ * @return The version threshold used by options without their own; 30 until setVersionThreshold is called.
+ */
+int QrParallel::getVersionThreshold() {
+    return versionThreshold.load();
+}
+
+/**
+ * Sets the version threshold used by options without their own.
+ *
+ * @param version The smallest version for which the thread budget is used; 41 to never use it.
+ */
+void QrParallel::setVersionThreshold(int version) {
+    versionThreshold.store(version);
+}
+
+/**
+ * Runs task(0) ... task(count - 1) on up to threadCount threads, including the calling one.
+ * The other threads come from a pool kept for the lifetime of the process, so calls do not start
+ * threads once the pool has grown to threadCount - 1. Threads take the next unclaimed index until all
+ * tasks are claimed; pool threads busy with other calls leave more tasks to the calling thread.
+ *
+ * @param count Number of tasks.
+ * @param threadCount Maximum number of threads.
+ * @param task The task to run for every index.
+ */
+void QrParallel::forEach(size_t count, int threadCount, const std::function<void(size_t)>& task) {
+    if (threadCount < 2 || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    Job job;
+    job.task = &task;
+    job.count = count;
+    job.nextIndex.store(0);
+    job.errors.resize(count);
+    job.openSeats = static_cast<int>(std::min(static_cast<size_t>(threadCount), count) - 1);
+    job.helpers = 0;
+    getWorkerPool().run(job);
+
+    for (const std::exception_ptr& error : job.errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include "../include/QrPrinterEmitter.hpp"
+#include "../include/QrRowRenderer.hpp"
+#include <string>
+#include <algorithm>
+
+const int QrPrinterEmitter::EscPosMaxBandRows;
+
+/**
+ * Constructs an InvalidPrinterParametersException with a specific error message.
+ *
+ * @param message The error message indicating the invalid parameters.
+ */
+InvalidPrinterParametersException::InvalidPrinterParametersException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+/**
+ * Writes the matrix as a ZPL ^GFA graphic field.
+ * Rows equal to the previous row are sent as ':', which makes every module row after its first dot row almost free.
+ *
+ * @param matrix The modules to print.
+ * @param dotsPerModule Width and height of one module in printer dots.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @param out The stream receiving the command.
+ */
+void QrPrinterEmitter::writeZpl(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone, std::ostream& out) {
+    checkParameters(dotsPerModule, quietZone);
+
+    int dots = (matrix.size() + 2 * quietZone) * dotsPerModule;
+    int bytesPerRow = (dots + 7) / 8;
+    long totalBytes = static_cast<long>(bytesPerRow) * dots;
+
+    out << "^GFA," << totalBytes << ',' << totalBytes << ',' << bytesPerRow << ',';
+
+    QrRowRenderer renderer(matrix, dotsPerModule, quietZone);
+    std::vector<unsigned char> previousRow(bytesPerRow);
+    while (const unsigned char* row = renderer.nextRow()) {
+        bool repeated = renderer.rowIndex() > 0 &&
+                        (renderer.repeatsPreviousRow() || std::equal(row, row + bytesPerRow, previousRow.begin()));
+        if (repeated) {
+            out << ':';
+        } else {
+            writeZplRow(row, bytesPerRow, out);
+            std::copy(row, row + bytesPerRow, previousRow.begin());
+        }
+    }
+}
+
+/**
+ * Writes the matrix as ESC/POS GS v 0 raster bit image commands, in bands of at most EscPosMaxBandRows dot rows.
+ *
+ * @param matrix The modules to print.
+ * @param dotsPerModule Width and height of one module in printer dots.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @param out The stream receiving the commands.
+ */
+void QrPrinterEmitter::writeEscPos(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone, std::ostream& out) {
+    checkParameters(dotsPerModule, quietZone);
+
+    int dots = (matrix.size() + 2 * quietZone) * dotsPerModule;
+    int bytesPerRow = (dots + 7) / 8;
+    if (bytesPerRow > 0xFFFF) {
+        throw InvalidPrinterParametersException("Raster row of " + std::to_string(bytesPerRow) + " bytes is too wide for GS v 0");
+    }
+
+    QrRowRenderer renderer(matrix, dotsPerModule, quietZone);
+    for (int bandStart = 0; bandStart < dots; bandStart += EscPosMaxBandRows) {
+        int bandRows = std::min(EscPosMaxBandRows, dots - bandStart);
+
+        // GS v 0 m xL xH yL yH
+        const char header[] = {
+            0x1D, 'v', '0', 0,
+            static_cast<char>(bytesPerRow & 0xFF), static_cast<char>(bytesPerRow >> 8),
+            static_cast<char>(bandRows & 0xFF), static_cast<char>(bandRows >> 8)
+        };
+        out.write(header, sizeof(header));
+
+        for (int dotRow = bandStart; dotRow < bandStart + bandRows; ++dotRow) {
+            out.write(reinterpret_cast<const char*>(renderer.nextRow()), bytesPerRow);
+        }
+    }
+}
+
+/**
+ * Writes one row of ZPL hex data.
+ * Runs of a hex digit are prefixed with a repeat count, and a row ending in zeros or ones
+ * is cut short with ',' or '!'.
+ *
+ * @param bytes The packed dot row.
+ * @param length Number of bytes in the row.
+ * @param out The stream receiving the data.
+ */
+void QrPrinterEmitter::writeZplRow(const unsigned char* bytes, int length, std::ostream& out) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+
+    std::string hex;
+    hex.reserve(length * 2);
+    for (int i = 0; i < length; ++i) {
+        hex += hexDigits[bytes[i] >> 4];
+        hex += hexDigits[bytes[i] & 0x0F];
+    }
+
+    // Positions from which the rest of the row is only zeros or only ones
+    size_t zeroTail = hex.find_last_not_of('0') + 1;
+    size_t onesTail = hex.find_last_not_of('F') + 1;
+
+    size_t position = 0;
+    while (position < hex.size()) {
+        if (position >= zeroTail) {
+            out << ',';
+            return;
+        }
+        if (position >= onesTail) {
+            out << '!';
+            return;
+        }
+
+        size_t runEnd = hex.find_first_not_of(hex[position], position);
+        if (runEnd == std::string::npos) {
+            runEnd = hex.size();
+        }
+        writeZplRun(static_cast<int>(runEnd - position), hex[position], out);
+        position = runEnd;
+    }
+}
+
+/**
+ * Writes a ZPL repeat count followed by the repeated hex digit.
+ * Counts use G-Y for 1-19 and g-z for multiples of 20 up to 400.
+ *
+ * @param count Number of repetitions of the digit.
+ * @param digit The hex digit.
+ * @param out The stream receiving the data.
+ */
+void QrPrinterEmitter::writeZplRun(int count, char digit, std::ostream& out) {
+    while (count > 0) {
+        int chunk = std::min(count, 419);
+        if (chunk > 1) {
+            if (chunk / 20 > 0) {
+                out << static_cast<char>('g' + chunk / 20 - 1);
+            }
+            if (chunk % 20 > 0) {
+                out << static_cast<char>('G' + chunk % 20 - 1);
+            }
+        }
+        out << digit;
+        count -= chunk;
+    }
+}
+
+/**
+ * Validates the common printer parameters.
+ *
+ * @param dotsPerModule Width and height of one module in dots.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @throws InvalidPrinterParametersException if dotsPerModule is not positive or quietZone is negative.
+ */
+void QrPrinterEmitter::checkParameters(int dotsPerModule, int quietZone) {
+    if (dotsPerModule < 1) {
+        throw InvalidPrinterParametersException("Dots per module must be positive");
+    }
+    if (quietZone < 0) {
+        throw InvalidPrinterParametersException("Quiet zone cannot be negative");
+    }
+}
@@ -0,0 +1,183 @@
+#include "../include/QrRowRenderer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Constructs an InvalidRenderParametersException with a specific error message.
+ *
+ * @param message The error message describing the invalid parameters.
+ */
+InvalidRenderParametersException::InvalidRenderParametersException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+namespace {
+
+/**
+ * Returns the index of the lowest set bit of a non-zero word.
+ */
+inline int findLowestBit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (((bits >> bit) & 1) == 0) {
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+/**
+ * Sets count dots starting at dot first, filling whole bytes at once.
+ *
+ * @param scanline The packed dot row.
+ * @param first The first dot.
+ * @param count Number of dots.
+ */
+void setDots(unsigned char* scanline, int first, int count) {
+    int end = first + count;
+    while (first < end && first % 8 != 0) {
+        scanline[first / 8] |= static_cast<unsigned char>(0x80 >> (first % 8));
+        ++first;
+    }
+    if (end - first >= 8) {
+        std::memset(&scanline[first / 8], 0xFF, (end - first) / 8);
+        first += (end - first) / 8 * 8;
+    }
+    while (first < end) {
+        scanline[first / 8] |= static_cast<unsigned char>(0x80 >> (first % 8));
+        ++first;
+    }
+}
+
+/**
+ * Expands the words of a module row into a cleared scanline, one run of dots per dark module.
+ *
+ * @param words The words of the module row.
+ * @param wordsPerRow Number of words of the row.
+ * @param quietZone Width of the light border in modules.
+ * @param dotsPerModule Width of one module in dots.
+ * @param scanline The packed dot row.
+ */
+void expandRow(const uint64_t* words, int wordsPerRow, int quietZone, int dotsPerModule, unsigned char* scanline) {
+    for (int word = 0; word < wordsPerRow; ++word) {
+        uint64_t bits = words[word];
+        while (bits != 0) {
+            int col = word * 64 + findLowestBit(bits);
+            bits &= bits - 1;
+            setDots(scanline, (col + quietZone) * dotsPerModule, dotsPerModule);
+        }
+    }
+}
+
+}
+
+/**
+ * Creates a renderer positioned before the first dot row.
+ *
+ * @param matrix The modules to render.
+ * @param dotsPerModule Width and height of one module in dots.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @throws InvalidRenderParametersException if dotsPerModule is not positive or quietZone is negative.
+ */
+QrRowRenderer::QrRowRenderer(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone)
+    : matrix(matrix), dotsPerModule(dotsPerModule), quietZone(quietZone), dots(0),
+      currentRow(-1), renderedModuleRow(-2), repeated(false) {
+    if (dotsPerModule < 1) {
+        throw InvalidRenderParametersException("Dots per module must be positive");
+    }
+    if (quietZone < 0) {
+        throw InvalidRenderParametersException("Quiet zone cannot be negative");
+    }
+    dots = (matrix.size() + 2 * quietZone) * dotsPerModule;
+    scanline.resize((dots + 7) / 8);
+}
+
+/**
+ * Computes the width and height in dots of a rendered symbol of the given version.
+ *
+ * @param version The version selected by QrVersionSelector::getQrVersion.
+ * @param dotsPerModule Width and height of one module in dots.
+ * @param quietZone Width of the light border around the symbol in modules.
+ * @return The size in dots.
+ * @throws InvalidVersionException if the version is outside 1-40.
+ */
+int QrRowRenderer::getDotSize(int version, int dotsPerModule, int quietZone) {
+    return (QrModuleMatrix::sizeForVersion(version) + 2 * quietZone) * dotsPerModule;
+}
+
+/**
+ * @return The width and height of the rendered symbol in dots.
+ */
+int QrRowRenderer::size() const {
+    return dots;
+}
+
+/**
+ * @return The number of bytes of a packed dot row.
+ */
+int QrRowRenderer::bytesPerRow() const {
+    return static_cast<int>(scanline.size());
+}
+
+/**
+ * @return The index of the row returned by the last nextRow call, or -1 before the first one.
+ */
+int QrRowRenderer::rowIndex() const {
+    return currentRow;
+}
+
+/**
+ * Renders the next dot row. The scanline is only expanded again when the module row changes.
+ *
+ * @return The packed row, valid until the next call; nullptr after the last row.
+ */
+const unsigned char* QrRowRenderer::nextRow() {
+    if (currentRow + 1 >= dots) {
+        currentRow = dots;
+        return nullptr;
+    }
+    ++currentRow;
+
+    int moduleRow = currentRow / dotsPerModule - quietZone;
+    if (moduleRow < 0 || moduleRow >= matrix.size()) {
+        moduleRow = -1;
+    }
+    if (moduleRow != renderedModuleRow) {
+        renderModuleRow(moduleRow);
+        repeated = false;
+    } else {
+        repeated = currentRow > 0;
+    }
+    return scanline.data();
+}
+
+/**
+ * @return True if the row returned by the last nextRow call is known to equal the one before it.
+ */
+bool QrRowRenderer::repeatsPreviousRow() const {
+    return repeated;
+}
+
+/**
+ * Moves back before the first dot row.
+ */
+void QrRowRenderer::reset() {
+    currentRow = -1;
+    repeated = false;
+}
+
+/**
+ * Expands a module row into the scanline.
+ *
+ * @param moduleRow The module row, or -1 for a quiet row.
+ */
+void QrRowRenderer::renderModuleRow(int moduleRow) {
+    std::fill(scanline.begin(), scanline.end(), 0);
+    renderedModuleRow = moduleRow;
+    if (moduleRow < 0) {
+        return;
+    }
+    expandRow(matrix.rowData(moduleRow), matrix.wordsPerRow(), quietZone, dotsPerModule, scanline.data());
+}
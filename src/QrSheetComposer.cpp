@@ -0,0 +1,233 @@
+#include "../include/QrSheetComposer.hpp"
+#include "../include/QrModeSelector.hpp"
+#include "../include/QrParallel.hpp"
+#include "../include/QrRowRenderer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+/**
+ * Constructs an InvalidSheetLayoutException with a specific error message.
+ *
+ * @param message The error message indicating the invalid layout.
+ */
+InvalidSheetLayoutException::InvalidSheetLayoutException(const std::string& message)
+    : std::invalid_argument(message) {}
+
+/**
+ * Computes the width of a symbol cell for a batch of payloads from their selected versions.
+ * The result is meant for QrSheetLayout::cellModules.
+ *
+ * @param payloads The payloads printed on the sheet.
+ * @param level The error correction level used for all payloads.
+ * @param quietZone Light border around every symbol in modules.
+ * @return The cell width in modules, or 0 if no payload can be encoded.
+ */
+int QrSheetComposer::getCellModules(const std::vector<std::string>& payloads, QrErrorCorrectionLevel level, int quietZone) {
+    int maxVersion = 0;
+    for (const std::string& payload : payloads) {
+        try {
+            QrMode mode = QrModeSelector::getQrMode(payload);
+            maxVersion = std::max(maxVersion, QrVersionSelector::getQrVersion(payload.length(), level, mode));
+        } catch (const std::invalid_argument&) {
+            continue;
+        }
+    }
+    return maxVersion == 0 ? 0 : QrModuleMatrix::sizeForVersion(maxVersion) + 2 * quietZone;
+}
+
+/**
+ * Renders the symbols into a binary PBM (P4) page.
+ * Every task renders one grid row, which covers its own band of page rows, so tasks never share memory.
+ *
+ * @param symbols The symbols, placed row by row.
+ * @param layout The grid and scale of the sheet.
+ * @param threadCount Maximum number of threads rendering grid rows.
+ * @param out The stream receiving the page.
+ */
+void QrSheetComposer::writePbm(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout, int threadCount, std::ostream& out) {
+    Geometry geometry = getGeometry(symbols, layout);
+    size_t bytesPerRow = (geometry.width + 7) / 8;
+    std::vector<unsigned char> page(bytesPerRow * geometry.height, 0);
+
+    QrParallel::forEach(geometry.gridRows, threadCount, [&](size_t gridRow) {
+        size_t first = gridRow * layout.columns;
+        size_t last = std::min(first + layout.columns, symbols.size());
+
+        for (size_t index = first; index < last; ++index) {
+            int x = 0;
+            int y = 0;
+            getSymbolOrigin(index, symbols[index], layout, geometry, x, y);
+
+            // Symbols start at any dot, so every rendered byte is split over two page bytes
+            QrRowRenderer renderer(symbols[index], layout.dotsPerModule, 0);
+            int shift = x % 8;
+            while (const unsigned char* dotRow = renderer.nextRow()) {
+                unsigned char* pageRow = &page[(y + renderer.rowIndex()) * bytesPerRow + x / 8];
+                for (int byte = 0; byte < renderer.bytesPerRow(); ++byte) {
+                    pageRow[byte] |= static_cast<unsigned char>(dotRow[byte] >> shift);
+                    unsigned char spill = static_cast<unsigned char>(dotRow[byte] << (8 - shift));
+                    if (spill != 0) {
+                        pageRow[byte + 1] |= spill;
+                    }
+                }
+            }
+        }
+    });
+
+    out << "P4\n" << geometry.width << ' ' << geometry.height << '\n';
+    out.write(reinterpret_cast<const char*>(page.data()), page.size());
+}
+
+/**
+ * Writes the symbols as a single page PDF with one filled path per symbol.
+ * Paths are built in parallel and written in symbol order.
+ *
+ * @param symbols The symbols, placed row by row.
+ * @param layout The grid and scale of the sheet.
+ * @param threadCount Maximum number of threads building symbol paths.
+ * @param out The stream receiving the document.
+ */
+void QrSheetComposer::writePdf(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout, int threadCount, std::ostream& out) {
+    Geometry geometry = getGeometry(symbols, layout);
+
+    std::vector<std::string> paths(symbols.size());
+    QrParallel::forEach(symbols.size(), threadCount, [&](size_t index) {
+        int x = 0;
+        int y = 0;
+        getSymbolOrigin(index, symbols[index], layout, geometry, x, y);
+        paths[index] = buildSymbolPath(symbols[index], x, y, layout.dotsPerModule);
+    });
+
+    // Content stream in dot units with the origin in the top-left corner
+    double scale = 72.0 / layout.dpi;
+    std::ostringstream content;
+    content << std::setprecision(6) << "q " << scale << " 0 0 " << -scale << " 0 " << geometry.height * scale << " cm\n";
+    for (const std::string& path : paths) {
+        content << path;
+    }
+    content << "Q\n";
+    std::string stream = content.str();
+
+    std::ostringstream pageSize;
+    pageSize << std::fixed << std::setprecision(2) << geometry.width * scale << ' ' << geometry.height * scale;
+
+    std::vector<std::string> objects;
+    objects.push_back("<< /Type /Catalog /Pages 2 0 R >>");
+    objects.push_back("<< /Type /Pages /Kids [3 0 R] /Count 1 >>");
+    objects.push_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 " + pageSize.str() + "] /Contents 4 0 R >>");
+    objects.push_back("<< /Length " + std::to_string(stream.size()) + " >>\nstream\n" + stream + "endstream");
+
+    std::string document = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        offsets.push_back(document.size());
+        document += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+
+    size_t xrefOffset = document.size();
+    document += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t offset : offsets) {
+        char entry[21];
+        std::snprintf(entry, sizeof(entry), "%010lu 00000 n \n", static_cast<unsigned long>(offset));
+        document += entry;
+    }
+    document += "trailer\n<< /Size " + std::to_string(objects.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+                std::to_string(xrefOffset) + "\n%%EOF\n";
+
+    out.write(document.data(), document.size());
+}
+
+/**
+ * Validates the layout and computes the page geometry.
+ * The cell fits the largest symbol unless the layout sets its size.
+ *
+ * @param symbols The symbols placed on the sheet.
+ * @param layout The grid and scale of the sheet.
+ * @return The page geometry.
+ * @throws InvalidSheetLayoutException if the layout is invalid.
+ */
+QrSheetComposer::Geometry QrSheetComposer::getGeometry(const std::vector<QrModuleMatrix>& symbols, const QrSheetLayout& layout) {
+    if (layout.columns < 1 || layout.dotsPerModule < 1 || layout.dpi < 1) {
+        throw InvalidSheetLayoutException("Sheet columns, dots per module and dpi must be positive");
+    }
+    if (layout.quietZone < 0 || layout.margin < 0 || layout.gutter < 0 || layout.cellModules < 0) {
+        throw InvalidSheetLayoutException("Sheet quiet zone, margin, gutter and cell size cannot be negative");
+    }
+    if (symbols.empty()) {
+        throw InvalidSheetLayoutException("Sheet needs at least one symbol");
+    }
+
+    int maxSize = 0;
+    for (const QrModuleMatrix& symbol : symbols) {
+        maxSize = std::max(maxSize, symbol.size());
+    }
+
+    Geometry geometry;
+    geometry.cellModules = maxSize + 2 * layout.quietZone;
+    if (layout.cellModules > 0) {
+        if (layout.cellModules < geometry.cellModules) {
+            throw InvalidSheetLayoutException("Sheet cell of " + std::to_string(layout.cellModules) +
+                                              " modules cannot hold a symbol of " + std::to_string(maxSize) + " modules");
+        }
+        geometry.cellModules = layout.cellModules;
+    }
+    geometry.cellDots = geometry.cellModules * layout.dotsPerModule;
+    geometry.gridRows = static_cast<int>((symbols.size() + layout.columns - 1) / layout.columns);
+    int gridColumns = std::min(layout.columns, static_cast<int>(symbols.size()));
+    geometry.width = 2 * layout.margin + gridColumns * geometry.cellDots + (gridColumns - 1) * layout.gutter;
+    geometry.height = 2 * layout.margin + geometry.gridRows * geometry.cellDots + (geometry.gridRows - 1) * layout.gutter;
+    return geometry;
+}
+
+/**
+ * Returns the position of the top-left module of a symbol on the page, centring it in its cell.
+ *
+ * @param index Index of the symbol on the sheet.
+ * @param symbol The symbol.
+ * @param layout The grid and scale of the sheet.
+ * @param geometry The page geometry.
+ * @param x Receives the horizontal position in dots.
+ * @param y Receives the vertical position in dots.
+ */
+void QrSheetComposer::getSymbolOrigin(size_t index, const QrModuleMatrix& symbol, const QrSheetLayout& layout, const Geometry& geometry, int& x, int& y) {
+    int offset = (geometry.cellModules - symbol.size()) / 2 * layout.dotsPerModule;
+    x = layout.margin + static_cast<int>(index % layout.columns) * (geometry.cellDots + layout.gutter) + offset;
+    y = layout.margin + static_cast<int>(index / layout.columns) * (geometry.cellDots + layout.gutter) + offset;
+}
+
+/**
+ * Builds the PDF path of one symbol: a rectangle per run of dark modules in a row, filled once.
+ * Symbols without dark modules produce no path.
+ *
+ * @param symbol The symbol.
+ * @param x Horizontal position of the symbol in dots.
+ * @param y Vertical position of the symbol in dots.
+ * @param dotsPerModule Width and height of one module in dots.
+ * @return The path operators.
+ */
+std::string QrSheetComposer::buildSymbolPath(const QrModuleMatrix& symbol, int x, int y, int dotsPerModule) {
+    std::ostringstream path;
+    bool empty = true;
+    for (int row = 0; row < symbol.size(); ++row) {
+        int col = 0;
+        while (col < symbol.size()) {
+            if (!symbol.get(row, col)) {
+                ++col;
+                continue;
+            }
+            int runStart = col;
+            while (col < symbol.size() && symbol.get(row, col)) {
+                ++col;
+            }
+            path << x + runStart * dotsPerModule << ' ' << y + row * dotsPerModule << ' '
+                 << (col - runStart) * dotsPerModule << ' ' << dotsPerModule << " re\n";
+            empty = false;
+        }
+    }
+    if (!empty) {
+        path << "f\n";
+    }
+    return path.str();
+}
@@ -1,4 +1,5 @@
 #include "../include/QrVersionSelector.hpp"
+#include "../include/QrModuleMatrix.hpp"
 
 
 /**
@@ -102,19 +103,42 @@ const int QrVersionSelector::dataCapacities[40][4][4] = {
 
 
 int QrVersionSelector::getQrVersion(const std::string& input, QrErrorCorrectionLevel level, QrMode mode) {
-    int dataLength = input.length();
-    
+    int version = findQrVersion(input.length(), level, mode);
+    if (version != 0) {
+        return version;
+    }
+
+    // If no version can contain the data, throw an exception
+    throw TooLongMessageException("Input: \""+input+"\" is too large to fit in any QR code version for the given error correction level and mode.");
+}
+
+int QrVersionSelector::getQrVersion(size_t dataLength, QrErrorCorrectionLevel level, QrMode mode) {
+    int version = findQrVersion(dataLength, level, mode);
+    if (version != 0) {
+        return version;
+    }
+
+    throw TooLongMessageException("Input of length " + std::to_string(dataLength) + " is too large to fit in any QR code version for the given error correction level and mode.");
+}
+
+int QrVersionSelector::getDataCapacity(int version, QrErrorCorrectionLevel level, QrMode mode) {
+    if (version < 1 || version > 40) {
+        throw InvalidVersionException("Version " + std::to_string(version) + " is not a valid QR code version");
+    }
+    return dataCapacities[version - 1][static_cast<int>(level)][static_cast<int>(mode)];
+}
+
+int QrVersionSelector::findQrVersion(size_t dataLength, QrErrorCorrectionLevel level, QrMode mode) {
     // Map error correction levels and encoding modes to their respective table indices
     int levelIndex = static_cast<int>(level);
     int modeIndex = static_cast<int>(mode);
 
     // Iterate through the versions (from 1 to 40) to find the minimum version that fits
     for (int version = 0; version < 40; ++version) {
-        if (dataCapacities[version][levelIndex][modeIndex] >= dataLength) {
+        if (static_cast<size_t>(dataCapacities[version][levelIndex][modeIndex]) >= dataLength) {
             return version + 1;  // Versions are 1-based, so add 1
         }
     }
 
-    // If no version can contain the data, throw an exception
-    throw TooLongMessageException("Input: \""+input+"\" is too large to fit in any QR code version for the given error correction level and mode.");
+    return 0;
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "../include/QrModeSelector.hpp"
 #include "../include/QrVersionSelector.hpp"
+#include "../include/QrBulkJob.hpp"
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 void printSelectedMode(QrMode mode)
 {
@@ -49,8 +51,50 @@ void printSelectedVersion(int version)
     std::cout << "using qr version " << version << std::endl;
 }
 
-int main()
+void printUsage()
 {
+    std::cout << "usage: CPP_QR" << std::endl;
+    std::cout << "       CPP_QR bulk <input> <output> [index/count]" << std::endl;
+    std::cout << "       CPP_QR merge <merged output> <shard outputs...>" << std::endl;
+}
+
+int runBulkCommand(int argc, char** argv)
+{
+    std::string command = argv[1];
+    try
+    {
+        if(command == "bulk" && (argc == 4 || argc == 5))
+        {
+            QrShardSpec shard = argc == 5 ? QrBulkJob::parseShardSpec(argv[4]) : QrShardSpec{0, 1};
+            size_t records = QrBulkJob::run(argv[2], argv[3], shard, QrEncodeOptions());
+            std::cout << "processed " << records << " records" << std::endl;
+            return 0;
+        }
+        else if(command == "merge" && argc >= 4)
+        {
+            std::vector<std::string> shardOutputs(argv + 3, argv + argc);
+            size_t records = QrBulkJob::merge(shardOutputs, argv[2]);
+            std::cout << "merged " << records << " records" << std::endl;
+            return 0;
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    printUsage();
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc > 1)
+    {
+        return runBulkCommand(argc, argv);
+    }
+
     std::string inputMessage = "HELLO WORLD";
     QrErrorCorrectionLevel level = QrErrorCorrectionLevel::MEDIUM;
 
@@ -0,0 +1,238 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrAsyncEncoder.hpp"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Test fixture for QrAsyncEncoder.
+ */
+class QrAsyncEncoderTest : public ::testing::Test {
+protected:
+    std::vector<std::function<void()>> queue;
+    QrExecutor queueExecutor;
+    QrEncodeOptions options;
+
+    void SetUp() override {
+        queueExecutor = [this](std::function<void()> task) {
+            queue.push_back(task);
+        };
+        options.level = QrErrorCorrectionLevel::LOW;
+        options.asyncInlineLength = 16;
+    }
+
+    /**
+     * @brief Runs the queued tasks in order.
+     */
+    void drainQueue() {
+        std::vector<std::function<void()>> tasks;
+        tasks.swap(queue);
+        for (std::function<void()>& task : tasks) {
+            task();
+        }
+    }
+};
+
+TEST_F(QrAsyncEncoderTest, TestSmallPayloadRunsInline) {
+    std::future<QrEncodeResult> future = QrAsyncEncoder::encodeAsync("12345", options, queueExecutor);
+    EXPECT_TRUE(queue.empty());
+    ASSERT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    QrEncodeResult result = future.get();
+    EXPECT_EQ(result.mode, QrMode::NumericMode);
+    EXPECT_EQ(result.version, 1);
+}
+
+TEST_F(QrAsyncEncoderTest, TestLargePayloadIsOffloaded) {
+    std::string payload = generateRandomAlphanumericString(1000);
+    std::future<QrEncodeResult> future = QrAsyncEncoder::encodeAsync(payload, options, queueExecutor);
+    ASSERT_EQ(queue.size(), 1u);
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+    drainQueue();
+    QrEncodeResult result = future.get();
+    QrMode mode = QrModeSelector::getQrMode(payload);
+    EXPECT_EQ(result.mode, mode);
+    EXPECT_EQ(result.version, QrVersionSelector::getQrVersion(payload, QrErrorCorrectionLevel::LOW, mode));
+
+    // Without an executor everything runs inline
+    std::future<QrEncodeResult> inlined = QrAsyncEncoder::encodeAsync(payload, options, QrExecutor());
+    EXPECT_EQ(inlined.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+}
+
+TEST_F(QrAsyncEncoderTest, TestErrorsReachTheFuture) {
+    std::future<QrEncodeResult> empty = QrAsyncEncoder::encodeAsync("", options, queueExecutor);
+    EXPECT_THROW(empty.get(), EmptyInputMessageException);
+    std::future<QrEncodeResult> tooLong = QrAsyncEncoder::encodeAsync(std::string(8000, '1'), options, queueExecutor);
+    drainQueue();
+    EXPECT_THROW(tooLong.get(), TooLongMessageException);
+}
+
+TEST_F(QrAsyncEncoderTest, TestCancellation) {
+    QrCancellationToken token;
+    std::future<QrEncodeResult> pending = QrAsyncEncoder::encodeAsync(std::string(500, 'A'), options, queueExecutor, token);
+    QrCancellationToken copy = token;
+    copy.cancel();
+    EXPECT_TRUE(token.isCancelled());
+
+    drainQueue();
+    EXPECT_THROW(pending.get(), QrCancelledException);
+    std::future<QrEncodeResult> small = QrAsyncEncoder::encodeAsync("ABC", options, queueExecutor, token);
+    EXPECT_THROW(small.get(), QrCancelledException);
+    EXPECT_FALSE(QrCancellationToken().isCancelled());
+}
+
+TEST_F(QrAsyncEncoderTest, TestBatch) {
+    std::vector<std::string> payloads;
+    payloads.push_back("1234");
+    payloads.push_back(std::string(300, '9'));
+    payloads.push_back("");
+    payloads.push_back("hello");
+    payloads.push_back(generateRandomByteString(400));
+
+    bool done = false;
+    std::vector<QrEncodeResult> results;
+    std::vector<std::exception_ptr> errors;
+    QrAsyncEncoder::encodeBatchAsync(payloads, options, queueExecutor, QrCancellationToken(),
+        [&](const std::vector<QrEncodeResult>& batchResults, const std::vector<std::exception_ptr>& batchErrors) {
+            done = true;
+            results = batchResults;
+            errors = batchErrors;
+        });
+    EXPECT_FALSE(done);
+    EXPECT_EQ(queue.size(), 2u);
+    drainQueue();
+    ASSERT_TRUE(done);
+
+    ASSERT_EQ(results.size(), payloads.size());
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        if (i == 2) {
+            EXPECT_TRUE(errors[i] != nullptr);
+            continue;
+        }
+        ASSERT_TRUE(errors[i] == nullptr) << "payload " << i;
+        QrEncodeResult expected = QrAsyncEncoder::encode(payloads[i], options);
+        EXPECT_EQ(results[i].mode, expected.mode);
+        EXPECT_EQ(results[i].version, expected.version);
+    }
+}
+
+TEST_F(QrAsyncEncoderTest, TestBatchWithFailingExecutor) {
+    // Accepts one task, then refuses every later one
+    QrExecutor failingExecutor = [this](std::function<void()> task) {
+        if (!queue.empty()) {
+            throw std::runtime_error("executor is full");
+        }
+        queue.push_back(task);
+    };
+
+    std::vector<std::string> payloads;
+    payloads.push_back(std::string(300, '1'));
+    payloads.push_back("42");
+    payloads.push_back(std::string(300, '2'));
+    payloads.push_back("43");
+
+    int calls = 0;
+    std::vector<QrEncodeResult> results;
+    std::vector<std::exception_ptr> errors;
+    QrAsyncEncoder::encodeBatchAsync(payloads, options, failingExecutor, QrCancellationToken(),
+        [&](const std::vector<QrEncodeResult>& batchResults, const std::vector<std::exception_ptr>& batchErrors) {
+            ++calls;
+            results = batchResults;
+            errors = batchErrors;
+        });
+    EXPECT_EQ(calls, 0);
+    drainQueue();
+    ASSERT_EQ(calls, 1);
+
+    EXPECT_TRUE(errors[0] == nullptr);
+    EXPECT_EQ(results[0].mode, QrMode::NumericMode);
+    EXPECT_TRUE(errors[1] == nullptr);
+    for (size_t i = 2; i < payloads.size(); ++i) {
+        ASSERT_TRUE(errors[i] != nullptr) << "payload " << i;
+        EXPECT_THROW(std::rethrow_exception(errors[i]), std::runtime_error);
+    }
+
+    // A refused first payload reports the whole batch right away
+    queue.push_back([] {});
+    calls = 0;
+    QrAsyncEncoder::encodeBatchAsync(payloads, options, failingExecutor, QrCancellationToken(),
+        [&](const std::vector<QrEncodeResult>&, const std::vector<std::exception_ptr>& batchErrors) {
+            ++calls;
+            errors = batchErrors;
+        });
+    EXPECT_EQ(calls, 1);
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        EXPECT_TRUE(errors[i] != nullptr) << "payload " << i;
+    }
+    queue.clear();
+}
+
+TEST_F(QrAsyncEncoderTest, TestBatchCallbackThrows) {
+    std::vector<std::string> payloads;
+    payloads.push_back(std::string(300, '1'));
+    payloads.push_back("42");
+    int calls = 0;
+    QrBatchCallback throwingCallback = [&](const std::vector<QrEncodeResult>&, const std::vector<std::exception_ptr>& errors) {
+        ++calls;
+        EXPECT_TRUE(errors[0] == nullptr);
+        EXPECT_TRUE(errors[1] == nullptr);
+        throw std::logic_error("callback failed");
+    };
+
+    // The last payload runs inline and completes the batch
+    QrExecutor immediateExecutor = [](std::function<void()> task) {
+        task();
+    };
+    EXPECT_THROW(QrAsyncEncoder::encodeBatchAsync(payloads, options, immediateExecutor, QrCancellationToken(), throwingCallback),
+                 std::logic_error);
+    EXPECT_EQ(calls, 1);
+
+    // The executor runs the last payload at once
+    std::swap(payloads[0], payloads[1]);
+    calls = 0;
+    EXPECT_THROW(QrAsyncEncoder::encodeBatchAsync(payloads, options, immediateExecutor, QrCancellationToken(), throwingCallback),
+                 std::logic_error);
+    EXPECT_EQ(calls, 1);
+
+    // A queued last payload completes the batch when the queue is drained
+    calls = 0;
+    QrAsyncEncoder::encodeBatchAsync(payloads, options, queueExecutor, QrCancellationToken(), throwingCallback);
+    EXPECT_EQ(calls, 0);
+    EXPECT_THROW(drainQueue(), std::logic_error);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(QrAsyncEncoderTest, TestBatchOnThreads) {
+    std::vector<std::thread> threads;
+    std::mutex threadsMutex;
+    QrExecutor threadExecutor = [&](std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        threads.push_back(std::thread(task));
+    };
+
+    std::vector<std::string> payloads;
+    for (int i = 0; i < 64; ++i) {
+        payloads.push_back(generateRandomAlphanumericString(i * 20));
+    }
+    std::promise<std::vector<QrEncodeResult>> promise;
+    options.asyncInlineLength = 100;
+    QrAsyncEncoder::encodeBatchAsync(payloads, options, threadExecutor, QrCancellationToken(),
+        [&](const std::vector<QrEncodeResult>& results, const std::vector<std::exception_ptr>&) {
+            promise.set_value(results);
+        });
+    std::vector<QrEncodeResult> results = promise.get_future().get();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 1; i < payloads.size(); ++i) {
+        QrEncodeResult expected = QrAsyncEncoder::encode(payloads[i], options);
+        EXPECT_EQ(results[i].mode, expected.mode);
+        EXPECT_EQ(results[i].version, expected.version);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrBitSlicedBatch.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrBitSlicedBatch.
+ */
+class QrBitSlicedBatchTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Reads one bit of one lane from the bit planes the slow way.
+     */
+    int laneBit(const std::vector<uint64_t>& planes, size_t lane, size_t byte, int bit) {
+        return static_cast<int>((planes[byte * 8 + bit] >> lane) & 1);
+    }
+};
+
+TEST_F(QrBitSlicedBatchTest, TestGroupByVersion) {
+    std::vector<std::string> payloads;
+    for (int x = 0; x < 100; ++x) {
+        payloads.push_back(std::to_string(1000000 + x));   // version 1
+    }
+    payloads.push_back(std::string(42, '0'));               // version 2
+    payloads.push_back("");                                 // rejected
+    payloads.push_back(std::string(7090, '0'));             // rejected
+
+    QrBatchPlan plan = QrBitSlicedBatch::group(payloads, QrErrorCorrectionLevel::LOW);
+
+    ASSERT_EQ(plan.groups.size(), 3u);
+    EXPECT_EQ(plan.groups[0].version, 1);
+    EXPECT_EQ(plan.groups[0].indices.size(), QrBitSlicedBatch::LaneCount);
+    EXPECT_EQ(plan.groups[1].version, 1);
+    EXPECT_EQ(plan.groups[1].indices.size(), 100 - QrBitSlicedBatch::LaneCount);
+    EXPECT_EQ(plan.groups[1].indices.front(), QrBitSlicedBatch::LaneCount);
+    EXPECT_EQ(plan.groups[2].version, 2);
+    EXPECT_EQ(plan.groups[2].indices, std::vector<size_t>(1, 100));
+    EXPECT_EQ(plan.groups[2].modes, std::vector<QrMode>(1, QrMode::NumericMode));
+    EXPECT_EQ(plan.rejected, (std::vector<size_t>{101, 102}));
+}
+
+TEST_F(QrBitSlicedBatchTest, TestTransposeLayout) {
+    std::vector<std::string> lanes;
+    lanes.push_back("\x80");
+    lanes.push_back(std::string("\x00\x01", 2));
+
+    std::vector<uint64_t> planes = QrBitSlicedBatch::transpose(lanes);
+    ASSERT_EQ(planes.size(), 64u);
+    EXPECT_EQ(laneBit(planes, 0, 0, 0), 1);
+    EXPECT_EQ(laneBit(planes, 1, 0, 0), 0);
+    EXPECT_EQ(laneBit(planes, 1, 1, 7), 1);
+    EXPECT_EQ(planes[0], 1u);
+    EXPECT_EQ(planes[15], 2u);
+}
+
+TEST_F(QrBitSlicedBatchTest, TestTransposeRoundTrip) {
+    std::mt19937 eng(42);
+    std::uniform_int_distribution<> lengthDistr(0, 100);
+    std::uniform_int_distribution<> byteDistr(0, 255);
+
+    for (size_t laneCount = 1; laneCount <= QrBitSlicedBatch::LaneCount; laneCount += 7) {
+        std::vector<std::string> lanes(laneCount);
+        std::vector<size_t> lengths(laneCount);
+        for (size_t lane = 0; lane < laneCount; ++lane) {
+            lengths[lane] = lengthDistr(eng);
+            for (size_t x = 0; x < lengths[lane]; ++x) {
+                lanes[lane] += static_cast<char>(byteDistr(eng));
+            }
+        }
+
+        std::vector<uint64_t> planes = QrBitSlicedBatch::transpose(lanes);
+        for (size_t lane = 0; lane < laneCount; ++lane) {
+            for (size_t byte = 0; byte < lengths[lane]; ++byte) {
+                for (int bit = 0; bit < 8; ++bit) {
+                    int expected = (static_cast<unsigned char>(lanes[lane][byte]) >> (7 - bit)) & 1;
+                    ASSERT_EQ(laneBit(planes, lane, byte, bit), expected);
+                }
+            }
+        }
+        ASSERT_EQ(QrBitSlicedBatch::untranspose(planes, lengths), lanes);
+    }
+}
+
+TEST_F(QrBitSlicedBatchTest, TestPenaltiesMatchMaskSelector) {
+    const int versions[] = {1, 7, 40};
+    const size_t laneCounts[] = {QrBitSlicedBatch::LaneCount, 13, 3};
+    for (int v = 0; v < 3; ++v) {
+        std::vector<QrModuleMatrix> symbols;
+        for (size_t lane = 0; lane < laneCounts[v]; ++lane) {
+            // Sparse and dense symbols reach the runs, finder patterns and balance penalties
+            symbols.push_back(generateRandomMatrix(versions[v], static_cast<unsigned int>(lane), 0.1 + 0.8 * (lane % 5) / 4));
+        }
+        std::vector<int> penalties = QrBitSlicedBatch::getPenalties(symbols);
+        ASSERT_EQ(penalties.size(), symbols.size());
+        for (size_t lane = 0; lane < symbols.size(); ++lane) {
+            ASSERT_EQ(penalties[lane], QrMaskSelector::getPenalty(symbols[lane])) << "version " << versions[v] << " lane " << lane;
+        }
+    }
+}
+
+TEST_F(QrBitSlicedBatchTest, TestMasksMatchMaskSelector) {
+    QrModuleMatrix reserved = QrModuleMatrix::fromVersion(3);
+    for (int row = 0; row < reserved.size(); ++row) {
+        for (int col = 0; col < reserved.size(); ++col) {
+            reserved.set(row, col, row < 9 && (col < 9 || col >= reserved.size() - 8));
+        }
+    }
+    std::vector<QrModuleMatrix> symbols;
+    for (unsigned int lane = 0; lane < 40; ++lane) {
+        symbols.push_back(generateRandomMatrix(3, 100 + lane, lane % 2 == 0 ? 0.5 : 0.3));
+    }
+
+    std::vector<QrMaskSelection> selections = QrBitSlicedBatch::selectMasks(symbols, reserved);
+    ASSERT_EQ(selections.size(), symbols.size());
+    QrEncodeOptions options;
+    options.maskStrategy = QrMaskStrategy::Exhaustive;
+    for (size_t lane = 0; lane < symbols.size(); ++lane) {
+        QrMaskSelection expected = QrMaskSelector::selectMask(symbols[lane], reserved, options);
+        EXPECT_EQ(selections[lane].mask, expected.mask) << "lane " << lane;
+        EXPECT_EQ(selections[lane].penalty, expected.penalty) << "lane " << lane;
+    }
+}
+
+TEST_F(QrBitSlicedBatchTest, TestMixedSizes) {
+    std::vector<QrModuleMatrix> symbols;
+    symbols.push_back(QrModuleMatrix::fromVersion(1));
+    symbols.push_back(QrModuleMatrix::fromVersion(2));
+    EXPECT_THROW(QrBitSlicedBatch::getPenalties(symbols), std::invalid_argument);
+    symbols.pop_back();
+    EXPECT_THROW(QrBitSlicedBatch::selectMasks(symbols, QrModuleMatrix::fromVersion(2)), std::invalid_argument);
+    EXPECT_TRUE(QrBitSlicedBatch::getPenalties(std::vector<QrModuleMatrix>()).empty());
+}
+
+TEST_F(QrBitSlicedBatchTest, TestTooManyLanes) {
+    std::vector<std::string> lanes(QrBitSlicedBatch::LaneCount + 1, "A");
+    EXPECT_THROW(QrBitSlicedBatch::transpose(lanes), std::invalid_argument);
+    EXPECT_THROW(QrBitSlicedBatch::untranspose(std::vector<uint64_t>(64), std::vector<size_t>(1, 9)), std::invalid_argument);
+    EXPECT_THROW(QrBitSlicedBatch::getPenalties(std::vector<QrModuleMatrix>(QrBitSlicedBatch::LaneCount + 1, QrModuleMatrix::fromVersion(1))),
+                 std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
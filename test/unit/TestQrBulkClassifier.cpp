@@ -0,0 +1,259 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrBulkClassifier.hpp"
+#include "../../include/QrParallel.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+/**
+ * @brief Test fixture for QrBulkClassifier.
+ */
+class QrBulkClassifierTest : public ::testing::Test {
+protected:
+    std::vector<int32_t> offsets;
+    std::vector<char> bytes;
+
+    void SetUp() override {
+        offsets.assign(1, 0);
+        bytes.clear();
+    }
+
+    /**
+     * @brief Appends a row to the column.
+     */
+    void addRow(const std::string& row) {
+        bytes.insert(bytes.end(), row.begin(), row.end());
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+    }
+
+    /**
+     * @brief Returns row i of the column.
+     */
+    std::string getRow(size_t i) {
+        return std::string(bytes.begin() + offsets[i], bytes.begin() + offsets[i + 1]);
+    }
+
+    /**
+     * @brief Classifies a row with QrModeSelector and QrVersionSelector.
+     */
+    QrBulkClassification classifyRow(const std::string& row, QrErrorCorrectionLevel level) {
+        QrBulkClassification result = {QrMode::ByteMode, 0};
+        try {
+            result.mode = QrModeSelector::getQrMode(row);
+            result.version = QrVersionSelector::getQrVersion(row.length(), level, result.mode);
+        } catch (const TooLongMessageException&) {
+            result.version = 0;
+        } catch (const std::invalid_argument&) {
+            result.mode = QrMode::ByteMode;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Builds a random row mostly from the given characters.
+     */
+    std::string createRow(std::mt19937& eng, const std::string& alphabet, size_t length) {
+        std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+        std::uniform_int_distribution<int> anyByte(0, 255);
+        std::uniform_int_distribution<int> noise(0, 15);
+        std::string row;
+        for (size_t i = 0; i < length; ++i) {
+            row += noise(eng) == 0 ? static_cast<char>(anyByte(eng)) : alphabet[pick(eng)];
+        }
+        return row;
+    }
+};
+
+TEST_F(QrBulkClassifierTest, TestModes) {
+    addRow("0123456789012345");
+    addRow("01234567890123X5");
+    addRow("HELLO WORLD $%*+-./:");
+    addRow("Hello World");
+    addRow(u8"żółw");
+    addRow("\x82\xa0\x82\xa2");
+    addRow("\x80");
+    addRow("");
+    addRow("\t\n0");
+
+    std::vector<QrBulkClassification> results = QrBulkClassifier::classify(offsets, bytes, QrErrorCorrectionLevel::LOW);
+    ASSERT_EQ(results.size(), 9u);
+    QrMode modes[] = {QrMode::NumericMode, QrMode::AlphanumericMode, QrMode::AlphanumericMode, QrMode::ByteMode,
+                      QrMode::ByteMode, QrMode::KanjiMode, QrMode::ByteMode, QrMode::ByteMode, QrMode::AlphanumericMode};
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].mode, modes[i]) << "row " << i;
+        EXPECT_EQ(results[i].version, i == 6 || i == 7 ? 0 : 1) << "row " << i;
+    }
+}
+
+TEST_F(QrBulkClassifierTest, TestVersionBoundaries) {
+    for (int version = 1; version <= 40; ++version) {
+        int capacity = QrVersionSelector::getDataCapacity(version, QrErrorCorrectionLevel::HIGH, QrMode::NumericMode);
+        addRow(std::string(capacity, '7'));
+        addRow(std::string(capacity + 1, '7'));
+    }
+
+    std::vector<QrBulkClassification> results = QrBulkClassifier::classify(offsets, bytes, QrErrorCorrectionLevel::HIGH);
+    for (int version = 1; version <= 40; ++version) {
+        EXPECT_EQ(results[2 * (version - 1)].version, version);
+        EXPECT_EQ(results[2 * (version - 1) + 1].version, version == 40 ? 0 : version + 1);
+    }
+}
+
+TEST_F(QrBulkClassifierTest, TestMatchesSelectors) {
+    std::mt19937 eng(34);
+    std::uniform_int_distribution<size_t> length(1, 48);
+    std::uniform_int_distribution<int> kind(0, 3);
+    const std::string alphabets[] = {"0123456789", "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:",
+                                     "abcdefghijklmnopqrstuvwxyz0123456789-_", "\x81\x9f\xe0\xef\x40\x7e\xa5\xfc"};
+    for (int i = 0; i < 20000; ++i) {
+        addRow(createRow(eng, alphabets[kind(eng)], length(eng)));
+    }
+    addRow(std::string(7089, '1'));
+    addRow(std::string(7090, '1'));
+
+    for (QrErrorCorrectionLevel level : {QrErrorCorrectionLevel::LOW, QrErrorCorrectionLevel::QUARTER}) {
+        std::vector<QrBulkClassification> serial = QrBulkClassifier::classify(offsets, bytes, level);
+        std::vector<QrBulkClassification> parallel = QrBulkClassifier::classify(offsets, bytes, level, 4);
+        ASSERT_EQ(serial.size(), offsets.size() - 1);
+        for (size_t row = 0; row < serial.size(); ++row) {
+            QrBulkClassification expected = classifyRow(getRow(row), level);
+            ASSERT_EQ(serial[row].mode, expected.mode) << "row " << row;
+            ASSERT_EQ(serial[row].version, expected.version) << "row " << row;
+            ASSERT_EQ(parallel[row].mode, expected.mode) << "row " << row;
+            ASSERT_EQ(parallel[row].version, expected.version) << "row " << row;
+        }
+    }
+}
+
+TEST_F(QrBulkClassifierTest, TestInvalidOffsets) {
+    addRow("0123");
+    addRow("ABCD");
+    addRow("abcd");
+    std::vector<QrBulkClassification> results(3);
+
+    std::vector<int32_t> negative = {-4, 0, 4, 8};
+    EXPECT_THROW(QrBulkClassifier::classify(negative, bytes, QrErrorCorrectionLevel::LOW), InvalidColumnException);
+    EXPECT_THROW(QrBulkClassifier::classify(negative.data(), bytes.data(), 3, QrErrorCorrectionLevel::LOW, results.data()),
+                 InvalidColumnException);
+
+    std::vector<int32_t> decreasing = {0, 8, 4, 12};
+    EXPECT_THROW(QrBulkClassifier::classify(decreasing, bytes, QrErrorCorrectionLevel::LOW), InvalidColumnException);
+    EXPECT_THROW(QrBulkClassifier::classify(decreasing.data(), bytes.data(), 3, QrErrorCorrectionLevel::LOW, results.data()),
+                 InvalidColumnException);
+
+    std::vector<int32_t> tooLarge = {0, 4, 8, 13};
+    EXPECT_THROW(QrBulkClassifier::classify(tooLarge, bytes, QrErrorCorrectionLevel::LOW), InvalidColumnException);
+
+    // The offsets need not start at zero, as in a slice of a larger column
+    std::vector<int32_t> slice = {4, 8, 12};
+    results = QrBulkClassifier::classify(slice, bytes, QrErrorCorrectionLevel::LOW);
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].mode, QrMode::AlphanumericMode);
+    EXPECT_EQ(results[1].mode, QrMode::ByteMode);
+    EXPECT_TRUE(QrBulkClassifier::classify(std::vector<int32_t>(), bytes, QrErrorCorrectionLevel::LOW).empty());
+}
+
+TEST_F(QrBulkClassifierTest, TestKernelVariantsAgree) {
+    std::mt19937 eng(41);
+    std::uniform_int_distribution<size_t> length(0, 40);
+    const std::string alphabet = "0123456789ABCZ $%:abcxyz\x81\x9f\xe0\xc5\x82";
+    for (int i = 0; i < 10000; ++i) {
+        addRow(createRow(eng, alphabet, length(eng)));
+    }
+
+    QrBulkTuning original = QrBulkClassifier::getTuning();
+    EXPECT_EQ(original.kernelLevel, QrCpuDispatch::detectLevel());
+    QrBulkTuning tuning = {QrCpuLevel::Generic, 0, original.parallelVersionThreshold};
+    QrBulkClassifier::setTuning(tuning);
+    std::vector<QrBulkClassification> expected = QrBulkClassifier::classify(offsets, bytes, QrErrorCorrectionLevel::MEDIUM);
+
+    for (int level = 1; level <= static_cast<int>(QrCpuDispatch::detectLevel()); ++level) {
+        tuning.kernelLevel = static_cast<QrCpuLevel>(level);
+        QrBulkClassifier::setTuning(tuning);
+        std::vector<QrBulkClassification> results = QrBulkClassifier::classify(offsets, bytes, QrErrorCorrectionLevel::MEDIUM, 3);
+        for (size_t row = 0; row < results.size(); ++row) {
+            ASSERT_EQ(results[row].mode, expected[row].mode) << "level " << level << " row " << row;
+            ASSERT_EQ(results[row].version, expected[row].version) << "level " << level << " row " << row;
+        }
+    }
+    if (QrCpuDispatch::detectLevel() != QrCpuLevel::Avx512) {
+        tuning.kernelLevel = QrCpuLevel::Avx512;
+        EXPECT_THROW(QrBulkClassifier::setTuning(tuning), UnsupportedCpuLevelException);
+    }
+    QrBulkClassifier::setTuning(original);
+}
+
+TEST_F(QrBulkClassifierTest, TestKernelsClassifyEveryByte) {
+    // Every byte alone and at every position of rows spanning several vector registers
+    std::string digits(100, '7');
+    for (int c = 0; c < 256; ++c) {
+        addRow(std::string(1, static_cast<char>(c)));
+        for (size_t position : {0, 15, 16, 31, 32, 63, 64, 99}) {
+            std::string row = digits;
+            row[position] = static_cast<char>(c);
+            addRow(row.substr(0, position + 1 + c % 3));
+        }
+    }
+    // The last rows end at the end of the column, where whole registers cannot be loaded
+    addRow("ABC");
+    addRow("1");
+
+    QrBulkTuning original = QrBulkClassifier::getTuning();
+    QrBulkTuning tuning = original;
+    for (int level = 0; level <= static_cast<int>(QrCpuDispatch::detectLevel()); ++level) {
+        tuning.kernelLevel = static_cast<QrCpuLevel>(level);
+        QrBulkClassifier::setTuning(tuning);
+        std::vector<QrBulkClassification> results = QrBulkClassifier::classify(offsets, bytes, QrErrorCorrectionLevel::HIGH);
+        for (size_t row = 0; row < results.size(); ++row) {
+            QrBulkClassification expected = classifyRow(getRow(row), QrErrorCorrectionLevel::HIGH);
+            ASSERT_EQ(results[row].mode, expected.mode) << "level " << level << " row " << row;
+            ASSERT_EQ(results[row].version, expected.version) << "level " << level << " row " << row;
+        }
+    }
+    QrBulkClassifier::setTuning(original);
+}
+
+TEST_F(QrBulkClassifierTest, TestCalibrationCache) {
+    QrBulkTuning original = QrBulkClassifier::getTuning();
+    std::string path = ::testing::TempDir() + "QrBulkClassifierTest_tuning";
+    std::remove(path.c_str());
+
+    QrBulkTuning measured = QrBulkClassifier::calibrate(path);
+    EXPECT_TRUE(QrCpuDispatch::isSupported(measured.kernelLevel));
+    EXPECT_GE(measured.parallelThreshold, 4096u);
+    EXPECT_GE(measured.parallelVersionThreshold, 1);
+    EXPECT_LE(measured.parallelVersionThreshold, 41);
+    EXPECT_EQ(QrBulkClassifier::getTuning().kernelLevel, measured.kernelLevel);
+    EXPECT_EQ(QrCpuDispatch::getKernelLevel(), measured.kernelLevel);
+    EXPECT_EQ(QrParallel::getVersionThreshold(), measured.parallelVersionThreshold);
+
+    // A valid cache is used as it is, even with settings a measurement would not pick
+    {
+        std::ofstream cache(path, std::ios::trunc);
+        cache << "format 2\ncpu " << QrCpuDispatch::getLevelName(QrCpuDispatch::detectLevel())
+              << "\ncores " << std::thread::hardware_concurrency() << "\nkernel generic\nthreshold 123\nversions 7\n";
+    }
+    QrBulkTuning cached = QrBulkClassifier::calibrate(path);
+    EXPECT_EQ(cached.kernelLevel, QrCpuLevel::Generic);
+    EXPECT_EQ(cached.parallelThreshold, 123u);
+    EXPECT_EQ(cached.parallelVersionThreshold, 7);
+    EXPECT_EQ(QrBulkClassifier::getTuning().parallelThreshold, 123u);
+    EXPECT_EQ(QrParallel::getVersionThreshold(), 7);
+
+    // A cache from another machine is measured again and rewritten
+    {
+        std::ofstream cache(path, std::ios::trunc);
+        cache << "format 2\ncpu generic\ncores 100000\nkernel generic\nthreshold 123\nversions 7\n";
+    }
+    EXPECT_NE(QrBulkClassifier::calibrate(path).parallelThreshold, 123u);
+    EXPECT_NE(QrBulkClassifier::calibrate(path).parallelThreshold, 123u);
+
+    std::remove(path.c_str());
+    QrBulkClassifier::setTuning(original);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
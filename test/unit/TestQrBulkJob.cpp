@@ -0,0 +1,212 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrBulkJob.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+
+/**
+ * @brief Test fixture for QrBulkJob. Works on a generated input file in the test temporary directory.
+ */
+class QrBulkJobTest : public ::testing::Test {
+protected:
+    std::string inputPath;
+
+    void SetUp() override {
+        inputPath = ::testing::TempDir() + "QrBulkJobTest_input.txt";
+        std::ofstream input(inputPath, std::ios::binary);
+        for (int x = 0; x < 500; ++x) {
+            switch (x % 5) {
+                case 0: input << generateRandomNumericString(1 + x % 30); break;
+                case 1: input << generateRandomAlphanumericString(x % 40); break;
+                case 2: input << "https://example.com/item/" << x; break;
+                case 3: break; // empty record
+                case 4: input << std::string(3000, 'a'); break;
+            }
+            input << '\n';
+        }
+        input << "LAST RECORD WITHOUT NEWLINE";
+    }
+
+    /**
+     * @brief Reads a whole file.
+     */
+    std::string readFile(const std::string& path) {
+        std::ifstream input(path, std::ios::binary);
+        std::ostringstream content;
+        content << input.rdbuf();
+        return content.str();
+    }
+
+    /**
+     * @brief Runs all shards of a job and returns the shard output paths.
+     */
+    std::vector<std::string> runShards(int count, uint64_t checkpointBytes, const QrEncodeOptions& options = QrEncodeOptions()) {
+        std::vector<std::string> outputs;
+        for (int index = 0; index < count; ++index) {
+            std::string outputPath = ::testing::TempDir() + "QrBulkJobTest_" + std::to_string(index) + "_" + std::to_string(count) + ".out";
+            std::remove(QrBulkJob::getManifestPath(outputPath).c_str());
+            QrShardSpec shard = {index, count};
+            QrBulkJob::run(inputPath, outputPath, shard, options, checkpointBytes);
+            outputs.push_back(outputPath);
+        }
+        return outputs;
+    }
+};
+
+TEST_F(QrBulkJobTest, TestParseShardSpec) {
+    QrShardSpec shard = QrBulkJob::parseShardSpec("2/8");
+    EXPECT_EQ(shard.index, 2);
+    EXPECT_EQ(shard.count, 8);
+    EXPECT_THROW(QrBulkJob::parseShardSpec("8/8"), InvalidShardException);
+    EXPECT_THROW(QrBulkJob::parseShardSpec("1-8"), InvalidShardException);
+    EXPECT_THROW(QrBulkJob::parseShardSpec("1/8x"), InvalidShardException);
+}
+
+TEST_F(QrBulkJobTest, TestShardRangesAreContiguous) {
+    std::string input = readFile(inputPath);
+    for (int count = 1; count <= 9; ++count) {
+        uint64_t expectedBegin = 0;
+        for (int index = 0; index < count; ++index) {
+            QrShardSpec shard = {index, count};
+            QrByteRange range = QrBulkJob::getShardRange(inputPath, shard);
+            ASSERT_EQ(range.begin, expectedBegin);
+            ASSERT_LE(range.begin, range.end);
+            ASSERT_TRUE(range.begin == 0 || input[range.begin - 1] == '\n');
+            expectedBegin = range.end;
+        }
+        ASSERT_EQ(expectedBegin, input.size());
+    }
+}
+
+TEST_F(QrBulkJobTest, TestRecordsAreClassified) {
+    std::vector<std::string> outputs = runShards(1, QrBulkJob::DefaultCheckpointBytes);
+    std::istringstream output(readFile(outputs[0]));
+
+    std::string line;
+    std::getline(output, line);
+    EXPECT_EQ(line.substr(0, 4), "0\t1\t");
+    EXPECT_NE(line.find("\tnumeric\t1"), std::string::npos);
+
+    std::vector<std::string> lines;
+    while (std::getline(output, line)) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(lines.size(), 500u);
+    EXPECT_NE(lines[1].find("\tbyte\t"), std::string::npos);
+    EXPECT_NE(lines[2].find("\t0\tinvalid\t0"), std::string::npos);
+    EXPECT_NE(lines[3].find("\t3000\tinvalid\t0"), std::string::npos);
+    EXPECT_NE(lines.back().find("\talphanumeric\t"), std::string::npos);
+    EXPECT_EQ(lines.back().substr(lines.back().size() - 5), "\tauto");
+
+    QrEncodeOptions options;
+    options.maskStrategy = QrMaskStrategy::Fixed;
+    options.fixedMask = 5;
+    outputs = runShards(1, QrBulkJob::DefaultCheckpointBytes, options);
+    output.clear();
+    output.str(readFile(outputs[0]));
+    std::getline(output, line);
+    EXPECT_EQ(line.substr(line.size() - 2), "\t5");
+}
+
+TEST_F(QrBulkJobTest, TestMergeMatchesSingleShard) {
+    std::vector<std::string> single = runShards(1, QrBulkJob::DefaultCheckpointBytes);
+    std::string mergedPath = ::testing::TempDir() + "QrBulkJobTest_merged.out";
+    for (int count = 2; count <= 7; ++count) {
+        std::vector<std::string> outputs = runShards(count, 7);
+        EXPECT_EQ(QrBulkJob::merge(outputs, mergedPath), 501u);
+        ASSERT_EQ(readFile(mergedPath), readFile(single[0]));
+    }
+
+    // Shards out of order or missing cannot be merged
+    std::vector<std::string> outputs = runShards(3, 7);
+    std::swap(outputs[0], outputs[1]);
+    EXPECT_THROW(QrBulkJob::merge(outputs, mergedPath), InvalidShardException);
+    outputs.pop_back();
+    EXPECT_THROW(QrBulkJob::merge(outputs, mergedPath), InvalidShardException);
+}
+
+TEST_F(QrBulkJobTest, TestMergeRejectsOtherOptions) {
+    std::string mergedPath = ::testing::TempDir() + "QrBulkJobTest_merged.out";
+    std::vector<std::string> outputs = runShards(2, 7);
+
+    // A shard rerun with another level or mask does not belong to the job
+    QrEncodeOptions options;
+    options.level = QrErrorCorrectionLevel::HIGH;
+    QrShardSpec shard = {1, 2};
+    std::remove(QrBulkJob::getManifestPath(outputs[1]).c_str());
+    QrBulkJob::run(inputPath, outputs[1], shard, options, 7);
+    EXPECT_THROW(QrBulkJob::merge(outputs, mergedPath), InvalidShardException);
+    EXPECT_THROW(QrBulkJob::run(inputPath, outputs[1], shard, QrEncodeOptions(), 7), InvalidShardException);
+
+    options = QrEncodeOptions();
+    options.maskStrategy = QrMaskStrategy::Fixed;
+    std::remove(QrBulkJob::getManifestPath(outputs[1]).c_str());
+    QrBulkJob::run(inputPath, outputs[1], shard, options, 7);
+    EXPECT_THROW(QrBulkJob::merge(outputs, mergedPath), InvalidShardException);
+
+    // A record whose version does not match the level in the manifest is rejected
+    outputs = runShards(2, 7);
+    EXPECT_EQ(QrBulkJob::merge(outputs, mergedPath), 501u);
+    std::string content = readFile(outputs[0]);
+    size_t field = content.find("\tnumeric\t1\t");
+    ASSERT_NE(field, std::string::npos);
+    content.replace(field, 11, "\tnumeric\t2\t");
+    std::ofstream(outputs[0], std::ios::binary | std::ios::trunc) << content;
+    EXPECT_THROW(QrBulkJob::merge(outputs, mergedPath), InvalidShardException);
+}
+
+TEST_F(QrBulkJobTest, TestResumeFromCheckpoint) {
+    std::vector<std::string> reference = runShards(1, 1000);
+    std::string expected = readFile(reference[0]);
+
+    // Simulate a crash after a checkpoint at the third record, with a partly written record after it
+    std::istringstream lines(expected);
+    std::string first, second, third;
+    std::getline(lines, first);
+    std::getline(lines, second);
+    std::getline(lines, third);
+    std::string outputPath = ::testing::TempDir() + "QrBulkJobTest_resume.out";
+    {
+        std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+        output << first << '\n' << second << '\n' << "12\t3";
+        std::ofstream manifest(QrBulkJob::getManifestPath(outputPath), std::ios::trunc);
+        QrShardSpec shard = {0, 1};
+        QrByteRange range = QrBulkJob::getShardRange(inputPath, shard);
+        manifest << "shard 0 1\nrange " << range.begin << ' ' << range.end << '\n'
+                 << "next " << third.substr(0, third.find('\t')) << '\n'
+                 << "output " << first.size() + second.size() + 2 << '\n'
+                 << "records 2\ncomplete 0\noptions 1 0 0\n";
+    }
+
+    QrShardSpec shard = {0, 1};
+    EXPECT_EQ(QrBulkJob::run(inputPath, outputPath, shard, QrEncodeOptions(), 5), 501u);
+    EXPECT_EQ(readFile(outputPath), expected);
+
+    // A complete shard is not processed again, and a manifest of another shard is rejected
+    EXPECT_EQ(QrBulkJob::run(inputPath, outputPath, shard, QrEncodeOptions(), 5), 501u);
+    QrShardSpec otherShard = {0, 2};
+    EXPECT_THROW(QrBulkJob::run(inputPath, outputPath, otherShard, QrEncodeOptions(), 5), InvalidShardException);
+}
+
+TEST_F(QrBulkJobTest, TestResumeRejectsShortOutput) {
+    // A manifest claiming more output than the file holds, as left by a crash without synced output
+    std::string outputPath = ::testing::TempDir() + "QrBulkJobTest_short.out";
+    {
+        std::ofstream output(outputPath, std::ios::binary | std::ios::trunc);
+        output << "0\t5\tnumeric\t1\tauto\n";
+        std::ofstream manifest(QrBulkJob::getManifestPath(outputPath), std::ios::trunc);
+        QrShardSpec shard = {0, 1};
+        QrByteRange range = QrBulkJob::getShardRange(inputPath, shard);
+        manifest << "shard 0 1\nrange " << range.begin << ' ' << range.end << '\n'
+                 << "next 500\noutput 4096\nrecords 40\ncomplete 0\noptions 1 0 0\n";
+    }
+
+    QrShardSpec shard = {0, 1};
+    EXPECT_THROW(QrBulkJob::run(inputPath, outputPath, shard, QrEncodeOptions(), 5), InvalidShardException);
+    // The output is left alone rather than padded to the claimed size
+    EXPECT_EQ(readFile(outputPath), "0\t5\tnumeric\t1\tauto\n");
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,112 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrCodewordPlacement.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+/**
+ * @brief Test fixture for QrCodewordPlacement.
+ */
+class QrCodewordPlacementTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Number of data modules of a version, computed from the sizes of the function patterns.
+     */
+    int getRawDataModules(int version) {
+        int result = (16 * version + 128) * version + 64;
+        if (version >= 2) {
+            int alignmentCount = version / 7 + 2;
+            result -= (25 * alignmentCount - 10) * alignmentCount - 55;
+            if (version >= 7) {
+                result -= 36;
+            }
+        }
+        return result;
+    }
+};
+
+TEST_F(QrCodewordPlacementTest, TestDataModuleCount) {
+    for (int version = 1; version <= 40; ++version) {
+        const QrPlacementTable& table = QrCodewordPlacement::getTable(version);
+        ASSERT_EQ(table.version, version);
+        ASSERT_EQ(table.positions.size(), static_cast<size_t>(getRawDataModules(version))) << "version " << version;
+    }
+    EXPECT_EQ(QrCodewordPlacement::getTable(1).positions.size(), 26u * 8);
+    EXPECT_EQ(QrCodewordPlacement::getTable(40).positions.size(), 3706u * 8);
+}
+
+TEST_F(QrCodewordPlacementTest, TestPositionsAreUniqueDataModules) {
+    for (int version = 1; version <= 40; ++version) {
+        const QrPlacementTable& table = QrCodewordPlacement::getTable(version);
+        QrModuleMatrix seen = QrModuleMatrix::fromVersion(version);
+        for (const QrModulePosition& position : table.positions) {
+            int col = position.word * 64 + position.bit;
+            ASSERT_FALSE(table.reserved.get(position.row, col));
+            ASSERT_FALSE(seen.get(position.row, col));
+            seen.set(position.row, col, true);
+        }
+    }
+}
+
+TEST_F(QrCodewordPlacementTest, TestZigZagOrder) {
+    const QrPlacementTable& table = QrCodewordPlacement::getTable(1);
+    int expected[][2] = {{20, 20}, {20, 19}, {19, 20}, {19, 19}, {18, 20}};
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(table.positions[i].row, expected[i][0]);
+        EXPECT_EQ(table.positions[i].word * 64 + table.positions[i].bit, expected[i][1]);
+    }
+    // The second column pair starts at the top and goes down
+    EXPECT_EQ(table.positions[24].row, 9);
+    EXPECT_EQ(table.positions[24].bit, 18);
+    EXPECT_EQ(table.positions[26].row, 10);
+}
+
+TEST_F(QrCodewordPlacementTest, TestAlignmentPositions) {
+    EXPECT_TRUE(QrCodewordPlacement::getAlignmentPositions(1).empty());
+    EXPECT_EQ(QrCodewordPlacement::getAlignmentPositions(2), (std::vector<int>{6, 18}));
+    EXPECT_EQ(QrCodewordPlacement::getAlignmentPositions(7), (std::vector<int>{6, 22, 38}));
+    EXPECT_EQ(QrCodewordPlacement::getAlignmentPositions(32), (std::vector<int>{6, 34, 60, 86, 112, 138}));
+    EXPECT_EQ(QrCodewordPlacement::getAlignmentPositions(40), (std::vector<int>{6, 30, 58, 86, 114, 142, 170}));
+}
+
+TEST_F(QrCodewordPlacementTest, TestPlaceCodewords) {
+    const QrPlacementTable& table = QrCodewordPlacement::getTable(5);
+    std::vector<uint8_t> codewords;
+    for (size_t i = 0; i < table.positions.size() / 8; ++i) {
+        codewords.push_back(static_cast<uint8_t>(i * 37 + 11));
+    }
+
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(5);
+    QrCodewordPlacement::placeCodewords(codewords, table, matrix);
+    for (size_t i = 0; i < codewords.size() * 8; ++i) {
+        const QrModulePosition& position = table.positions[i];
+        bool expected = (codewords[i / 8] >> (7 - i % 8)) & 1;
+        ASSERT_EQ(matrix.get(position.row, position.word * 64 + position.bit), expected);
+    }
+
+    codewords.push_back(0);
+    EXPECT_THROW(QrCodewordPlacement::placeCodewords(codewords, table, matrix), std::invalid_argument);
+    QrModuleMatrix wrongSize = QrModuleMatrix::fromVersion(6);
+    EXPECT_THROW(QrCodewordPlacement::placeCodewords(std::vector<uint8_t>(), table, wrongSize), std::invalid_argument);
+    EXPECT_THROW(QrCodewordPlacement::getTable(0), InvalidVersionException);
+}
+
+TEST_F(QrCodewordPlacementTest, TestTablesAreSharedBetweenThreads) {
+    const QrPlacementTable* tables[8];
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.push_back(std::thread([&tables, i]() {
+            tables[i] = &QrCodewordPlacement::getTable(33);
+        }));
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (int i = 1; i < 8; ++i) {
+        EXPECT_EQ(tables[i], tables[0]);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
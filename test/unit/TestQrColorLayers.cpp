@@ -0,0 +1,119 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrColorLayers.hpp"
+#include "../../include/QrVersionSelector.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+/**
+ * @brief Test fixture for QrColorLayers.
+ */
+class QrColorLayersTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Builds three layers of the given version with random dark modules.
+     */
+    std::vector<QrModuleMatrix> createLayers(int version, unsigned int seed) {
+        std::vector<QrModuleMatrix> layers;
+        for (int layer = 0; layer < QrColorLayers::LayerCount; ++layer) {
+            layers.push_back(generateRandomMatrix(version, seed * QrColorLayers::LayerCount + layer));
+        }
+        return layers;
+    }
+
+    /**
+     * @brief Checks that the payload splits into valid parts of the same mode which join back.
+     */
+    void checkSplit(const std::string& payload) {
+        std::vector<std::string> layers = QrColorLayers::splitPayload(payload);
+        ASSERT_EQ(layers.size(), 3u);
+        EXPECT_EQ(QrColorLayers::joinLayers(layers), payload);
+        QrMode mode = QrModeSelector::getQrMode(payload);
+        for (const std::string& layer : layers) {
+            ASSERT_FALSE(layer.empty());
+            EXPECT_LE(static_cast<int>(QrModeSelector::getQrMode(layer)), static_cast<int>(mode));
+            EXPECT_LE(layer.length(), payload.length() / 3 + 4);
+        }
+    }
+};
+
+TEST_F(QrColorLayersTest, TestSplitKeepsCharacters) {
+    checkSplit(generateRandomNumericString(1000));
+    checkSplit(generateRandomAlphanumericString(301));
+    checkSplit(generateRandomByteString(500));
+    checkSplit(u8"ąęć");
+    checkSplit("\x82\xa0\x82\xa2\x82\xa4\x82\xa6\x82\xa8");
+    // 0xE0 is a single byte character for isKanji, so the split must not pair it with the next byte
+    checkSplit("\xE0\x81\x40\x41\x42\x43");
+    checkSplit("123");
+    EXPECT_THROW(QrColorLayers::splitPayload("12"), InvalidColorLayerException);
+    EXPECT_THROW(QrColorLayers::splitPayload(u8"żó"), InvalidColorLayerException);
+    EXPECT_THROW(QrColorLayers::splitPayload(""), EmptyInputMessageException);
+}
+
+TEST_F(QrColorLayersTest, TestPlanTriplesCapacity) {
+    QrEncodeOptions options;
+    options.level = QrErrorCorrectionLevel::LOW;
+    std::string payload(3 * 2953, 'a');
+    EXPECT_THROW(QrColorLayers::plan(payload, options), InvalidColorLayerException);
+
+    options.colorModel = QrColorModel::Rgb;
+    QrColorLayerPlan plan = QrColorLayers::plan(payload, options);
+    ASSERT_EQ(plan.layers.size(), 3u);
+    EXPECT_EQ(plan.version, 40);
+    for (int layer = 0; layer < 3; ++layer) {
+        EXPECT_EQ(plan.modes[layer], QrMode::ByteMode);
+        EXPECT_EQ(plan.versions[layer], 40);
+    }
+    EXPECT_THROW(QrColorLayers::plan(payload + "a", options), TooLongMessageException);
+
+    plan = QrColorLayers::plan(std::string(100, '5') + "ABC", options);
+    EXPECT_EQ(plan.modes[0], QrMode::NumericMode);
+    EXPECT_EQ(plan.modes[2], QrMode::AlphanumericMode);
+    EXPECT_EQ(plan.version, *std::max_element(plan.versions.begin(), plan.versions.end()));
+}
+
+TEST_F(QrColorLayersTest, TestRgbRoundTrip) {
+    std::vector<QrModuleMatrix> layers = createLayers(7, 37);
+    std::stringstream image;
+    QrColorLayers::writeImage(layers, QrColorModel::Rgb, 3, 4, image);
+    EXPECT_EQ(image.str().substr(0, 13), "P6\n159 159\n25");
+
+    std::vector<QrModuleMatrix> decoded = QrColorLayers::readImage(image, QrColorModel::Rgb, 3, 4);
+    ASSERT_EQ(decoded.size(), 3u);
+    for (int layer = 0; layer < 3; ++layer) {
+        EXPECT_TRUE(decoded[layer] == layers[layer]) << "layer " << layer;
+    }
+}
+
+TEST_F(QrColorLayersTest, TestCmyRoundTrip) {
+    std::vector<QrModuleMatrix> layers = createLayers(2, 38);
+    std::stringstream image;
+    QrColorLayers::writeImage(layers, QrColorModel::Cmy, 5, 2, image);
+
+    std::vector<QrModuleMatrix> decoded = QrColorLayers::readImage(image, QrColorModel::Cmy, 5, 2);
+    ASSERT_EQ(decoded.size(), 3u);
+    for (int layer = 0; layer < 3; ++layer) {
+        EXPECT_TRUE(decoded[layer] == layers[layer]) << "layer " << layer;
+    }
+}
+
+TEST_F(QrColorLayersTest, TestInvalidLayers) {
+    std::vector<QrModuleMatrix> layers = createLayers(1, 39);
+    std::ostringstream out;
+    EXPECT_THROW(QrColorLayers::writeImage(layers, QrColorModel::None, 1, 0, out), InvalidColorLayerException);
+    layers[2] = QrModuleMatrix::fromVersion(2);
+    EXPECT_THROW(QrColorLayers::writeImage(layers, QrColorModel::Rgb, 1, 0, out), InvalidColorLayerException);
+    layers.pop_back();
+    EXPECT_THROW(QrColorLayers::writeImage(layers, QrColorModel::Rgb, 1, 0, out), InvalidColorLayerException);
+
+    std::stringstream image;
+    QrColorLayers::writeImage(createLayers(1, 40), QrColorModel::Rgb, 2, 1, image);
+    EXPECT_THROW(QrColorLayers::readImage(image, QrColorModel::Rgb, 3, 1), InvalidColorLayerException);
+    std::istringstream truncated("P6\n10 10\n255\nabc");
+    EXPECT_THROW(QrColorLayers::readImage(truncated, QrColorModel::Rgb, 1, 0), InvalidColorLayerException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
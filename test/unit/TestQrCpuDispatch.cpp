@@ -0,0 +1,45 @@
+#include "../../include/QrCpuDispatch.hpp"
+#include <gtest/gtest.h>
+
+TEST(QrCpuDispatchTest, TestDetectedLevelIsSupported) {
+    QrCpuLevel level = QrCpuDispatch::detectLevel();
+    EXPECT_EQ(QrCpuDispatch::detectLevel(), level);
+    EXPECT_TRUE(QrCpuDispatch::isSupported(QrCpuLevel::Generic));
+    EXPECT_TRUE(QrCpuDispatch::isSupported(level));
+    if (level != QrCpuLevel::Avx512) {
+        EXPECT_FALSE(QrCpuDispatch::isSupported(static_cast<QrCpuLevel>(static_cast<int>(level) + 1)));
+    }
+#ifndef CPP_QR_CPU_VARIANTS
+    EXPECT_EQ(level, QrCpuLevel::Generic);
+#endif
+}
+
+TEST(QrCpuDispatchTest, TestKernelLevel) {
+    QrCpuLevel detected = QrCpuDispatch::detectLevel();
+    EXPECT_EQ(QrCpuDispatch::getKernelLevel(), detected);
+    QrCpuDispatch::setKernelLevel(QrCpuLevel::Generic);
+    EXPECT_EQ(QrCpuDispatch::getKernelLevel(), QrCpuLevel::Generic);
+    if (detected != QrCpuLevel::Avx512) {
+        EXPECT_THROW(QrCpuDispatch::setKernelLevel(QrCpuLevel::Avx512), UnsupportedCpuLevelException);
+        EXPECT_EQ(QrCpuDispatch::getKernelLevel(), QrCpuLevel::Generic);
+    }
+    QrCpuDispatch::setKernelLevel(detected);
+    EXPECT_EQ(QrCpuDispatch::getKernelLevel(), detected);
+}
+
+TEST(QrCpuDispatchTest, TestLevelNames) {
+    for (QrCpuLevel level : {QrCpuLevel::Generic, QrCpuLevel::Sse42, QrCpuLevel::Avx2, QrCpuLevel::Avx512}) {
+        QrCpuLevel parsed = QrCpuLevel::Generic;
+        ASSERT_TRUE(QrCpuDispatch::parseLevelName(QrCpuDispatch::getLevelName(level), parsed));
+        EXPECT_EQ(parsed, level);
+    }
+    QrCpuLevel parsed = QrCpuLevel::Avx2;
+    EXPECT_EQ(QrCpuDispatch::getLevelName(QrCpuLevel::Sse42), "sse4.2");
+    EXPECT_FALSE(QrCpuDispatch::parseLevelName("neon", parsed));
+    EXPECT_EQ(parsed, QrCpuLevel::Avx2);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
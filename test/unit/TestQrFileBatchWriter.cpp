@@ -0,0 +1,155 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrFileBatchWriter.hpp"
+#include "../../include/QrRowRenderer.hpp"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+/**
+ * @brief Test fixture for QrFileBatchWriter.
+ */
+class QrFileBatchWriterTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Creates an empty directory for one test under the gtest temporary directory.
+     */
+    std::string createDirectory(const std::string& name) {
+        std::string path = ::testing::TempDir() + "QrFileBatchWriterTest_" + name;
+        mkdir(path.c_str(), 0755);
+        return path + "/";
+    }
+
+    /**
+     * @brief Reads a whole file.
+     */
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    /**
+     * @brief Writes files of different sizes through a small batch buffer, so several batches are written.
+     */
+    void checkBackend(QrFileBackend backend, const std::string& name) {
+        std::string directory = createDirectory(name);
+        QrFileBatchOptions options;
+        options.batchBytes = 4096;
+        options.threadCount = 3;
+        options.queueDepth = 12;
+        std::unique_ptr<QrFileBatchWriter> writer = QrFileBatchWriter::create(backend, options);
+
+        const int fileCount = 200;
+        for (int i = 0; i < fileCount; ++i) {
+            std::string content = "file " + std::to_string(i) + std::string(i * 7 % 300, static_cast<char>('a' + i % 26));
+            unsigned char* data = writer->reserve(content.size());
+            std::copy(content.begin(), content.end(), data);
+            writer->commit(directory + std::to_string(i) + ".txt");
+        }
+        writer->flush();
+        EXPECT_EQ(writer->getFileCount(), static_cast<uint64_t>(fileCount));
+
+        for (int i = 0; i < fileCount; ++i) {
+            std::string expected = "file " + std::to_string(i) + std::string(i * 7 % 300, static_cast<char>('a' + i % 26));
+            ASSERT_EQ(readFile(directory + std::to_string(i) + ".txt"), expected) << "file " << i;
+        }
+    }
+
+    /**
+     * @brief Fails one file of a batch and checks that the writer still writes the following batches.
+     */
+    void checkRecovery(QrFileBackend backend, const std::string& name) {
+        std::string directory = createDirectory(name);
+        QrFileBatchOptions options;
+        options.threadCount = 3;
+        options.queueDepth = 12;
+        std::unique_ptr<QrFileBatchWriter> writer = QrFileBatchWriter::create(backend, options);
+
+        for (int i = 0; i < 6; ++i) {
+            writer->reserve(1)[0] = 'x';
+            writer->commit(i == 2 ? directory + "missing/file.txt" : directory + "first" + std::to_string(i));
+        }
+        EXPECT_THROW(writer->flush(), QrFileWriteException);
+
+        // More files than io_uring slots, so every slot of the failed batch is used again
+        for (int i = 0; i < 20; ++i) {
+            std::string content(i + 1, static_cast<char>('a' + i));
+            unsigned char* data = writer->reserve(content.size());
+            std::copy(content.begin(), content.end(), data);
+            writer->commit(directory + "second" + std::to_string(i));
+        }
+        writer->flush();
+        for (int i = 0; i < 20; ++i) {
+            ASSERT_EQ(readFile(directory + "second" + std::to_string(i)), std::string(i + 1, static_cast<char>('a' + i))) << "file " << i;
+        }
+    }
+};
+
+TEST_F(QrFileBatchWriterTest, TestPosixBackend) {
+    checkBackend(QrFileBackend::Posix, "posix");
+}
+
+TEST_F(QrFileBatchWriterTest, TestThreadPoolBackend) {
+    checkBackend(QrFileBackend::ThreadPool, "pool");
+}
+
+TEST_F(QrFileBatchWriterTest, TestIoUringBackend) {
+    if (!QrFileBatchWriter::isAvailable(QrFileBackend::IoUring)) {
+        EXPECT_THROW(QrFileBatchWriter::create(QrFileBackend::IoUring), QrFileWriteException);
+        return;
+    }
+    checkBackend(QrFileBackend::IoUring, "uring");
+}
+
+TEST_F(QrFileBatchWriterTest, TestRecoveryAfterFailedFile) {
+    checkRecovery(QrFileBackend::Posix, "posix_recovery");
+    checkRecovery(QrFileBackend::ThreadPool, "pool_recovery");
+    if (QrFileBatchWriter::isAvailable(QrFileBackend::IoUring)) {
+        checkRecovery(QrFileBackend::IoUring, "uring_recovery");
+    }
+}
+
+TEST_F(QrFileBatchWriterTest, TestPbmMatchesRenderer) {
+    std::string directory = createDirectory("pbm");
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(2);
+    for (int row = 0; row < matrix.size(); ++row) {
+        for (int col = 0; col < matrix.size(); ++col) {
+            matrix.set(row, col, (row * 3 + col * 5) % 7 < 3);
+        }
+    }
+
+    {
+        std::unique_ptr<QrFileBatchWriter> writer = QrFileBatchWriter::create(QrFileBackend::Posix);
+        writer->writePbm(directory + "symbol.pbm", matrix, 3, 4);
+        // The destructor writes the remaining batch
+    }
+
+    QrRowRenderer renderer(matrix, 3, 4);
+    std::string expected = "P4\n" + std::to_string(renderer.size()) + " " + std::to_string(renderer.size()) + "\n";
+    while (const unsigned char* row = renderer.nextRow()) {
+        expected.append(reinterpret_cast<const char*>(row), renderer.bytesPerRow());
+    }
+    EXPECT_EQ(readFile(directory + "symbol.pbm"), expected);
+}
+
+TEST_F(QrFileBatchWriterTest, TestErrors) {
+    QrFileBatchOptions options;
+    options.batchBytes = 64;
+    std::unique_ptr<QrFileBatchWriter> writer = QrFileBatchWriter::create(QrFileBackend::Posix, options);
+    EXPECT_THROW(writer->reserve(65), QrFileWriteException);
+
+    writer->reserve(1)[0] = 'x';
+    writer->commit(createDirectory("errors") + "missing/file.txt");
+    EXPECT_THROW(writer->flush(), QrFileWriteException);
+    EXPECT_EQ(writer->getFileCount(), 0u);
+
+    options.threadCount = 0;
+    EXPECT_THROW(QrFileBatchWriter::create(QrFileBackend::ThreadPool, options), QrFileWriteException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
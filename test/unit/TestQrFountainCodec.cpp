@@ -0,0 +1,146 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrFountainCodec.hpp"
+#include "../../include/QrModuleMatrix.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+/**
+ * @brief Test fixture for QrFountainEncoder and QrFountainDecoder.
+ */
+class QrFountainCodecTest : public ::testing::Test {
+protected:
+    QrEncodeOptions options;
+
+    void SetUp() override {
+        options.level = QrErrorCorrectionLevel::LOW;
+    }
+
+    /**
+     * @brief Builds a payload of random bytes.
+     */
+    std::string createPayload(size_t length, unsigned int seed) {
+        std::mt19937 eng(seed);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::string payload;
+        for (size_t i = 0; i < length; ++i) {
+            payload += static_cast<char>(byte(eng));
+        }
+        return payload;
+    }
+
+    /**
+     * @brief Writes bytes in Base45, for building frames by hand.
+     */
+    std::string toBase45(const std::vector<uint8_t>& bytes) {
+        const std::string alphabet = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ $%*+-./:";
+        std::string text;
+        for (size_t i = 0; i < bytes.size(); i += 2) {
+            unsigned int value = i + 1 < bytes.size() ? bytes[i] * 256u + bytes[i + 1] : bytes[i];
+            text += alphabet[value % 45];
+            text += alphabet[value / 45 % 45];
+            if (i + 1 < bytes.size()) {
+                text += alphabet[value / 2025];
+            }
+        }
+        return text;
+    }
+};
+
+TEST_F(QrFountainCodecTest, TestBlockSizeFitsVersion) {
+    for (int version : {3, 10, 25, 40}) {
+        size_t blockSize = QrFountainEncoder::getBlockSize(version, QrErrorCorrectionLevel::MEDIUM);
+        options.level = QrErrorCorrectionLevel::MEDIUM;
+        std::vector<QrFountainFrame> frames = QrFountainEncoder::encodeFrames(createPayload(3 * blockSize, 1), blockSize, 0, 4, options);
+        for (const QrFountainFrame& frame : frames) {
+            EXPECT_EQ(frame.mode, QrMode::AlphanumericMode);
+            EXPECT_EQ(frame.version, version);
+        }
+    }
+    EXPECT_THROW(QrFountainEncoder::getBlockSize(1, QrErrorCorrectionLevel::HIGH), InvalidFountainDataException);
+    EXPECT_THROW(QrFountainEncoder::getBlockSize(41, QrErrorCorrectionLevel::LOW), InvalidVersionException);
+    EXPECT_EQ(QrFountainEncoder::getBlockCount(1000, 100), 10u);
+    EXPECT_EQ(QrFountainEncoder::getBlockCount(1001, 100), 11u);
+}
+
+TEST_F(QrFountainCodecTest, TestSystematicFramesDecode) {
+    std::string payload = createPayload(1234, 2);
+    std::vector<QrFountainFrame> frames = QrFountainEncoder::encodeFrames(payload, 100, 0, 13, options);
+    QrFountainDecoder decoder;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        EXPECT_FALSE(decoder.isComplete());
+        EXPECT_TRUE(decoder.addFrame(frames[i].text));
+    }
+    EXPECT_FALSE(decoder.addFrame(frames[0].text));
+    ASSERT_TRUE(decoder.isComplete());
+    EXPECT_EQ(decoder.getPayload(), payload);
+}
+
+TEST_F(QrFountainCodecTest, TestAnyOrderWithLosses) {
+    std::string payload = createPayload(200 * 1000 + 17, 3);
+    size_t blockSize = QrFountainEncoder::getBlockSize(20, QrErrorCorrectionLevel::LOW);
+    size_t blockCount = QrFountainEncoder::getBlockCount(payload.length(), blockSize);
+    options.threadBudget = 4;
+    std::vector<QrFountainFrame> frames = QrFountainEncoder::encodeFrames(payload, blockSize, 0, blockCount * 3, options);
+
+    // Drop half of the frames, including most of the systematic ones, and shuffle the rest
+    std::mt19937 eng(4);
+    std::shuffle(frames.begin(), frames.end(), eng);
+    frames.resize(frames.size() / 2);
+
+    QrFountainDecoder decoder;
+    size_t used = 0;
+    for (const QrFountainFrame& frame : frames) {
+        decoder.addFrame(frame.text);
+        ++used;
+        if (decoder.isComplete()) {
+            break;
+        }
+    }
+    ASSERT_TRUE(decoder.isComplete());
+    EXPECT_EQ(decoder.getBlockCount(), blockCount);
+    EXPECT_LT(used, blockCount * 3 / 2);
+    EXPECT_EQ(decoder.getPayload(), payload);
+}
+
+TEST_F(QrFountainCodecTest, TestParallelFramesMatchSerial) {
+    std::string payload = createPayload(5000, 5);
+    std::vector<QrFountainFrame> serial = QrFountainEncoder::encodeFrames(payload, 150, 30, 40, options);
+    options.threadBudget = 3;
+    std::vector<QrFountainFrame> parallel = QrFountainEncoder::encodeFrames(payload, 150, 30, 40, options);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+        EXPECT_EQ(serial[i].index, 30 + i);
+        EXPECT_EQ(serial[i].text, parallel[i].text);
+        EXPECT_EQ(serial[i].version, parallel[i].version);
+    }
+}
+
+TEST_F(QrFountainCodecTest, TestInvalidFrames) {
+    std::vector<QrFountainFrame> first = QrFountainEncoder::encodeFrames(createPayload(500, 6), 100, 0, 2, options);
+    std::vector<QrFountainFrame> other = QrFountainEncoder::encodeFrames(createPayload(500, 7), 100, 0, 1, options);
+
+    QrFountainDecoder decoder;
+    EXPECT_THROW(decoder.addFrame("hello"), InvalidFountainDataException);
+    EXPECT_THROW(decoder.addFrame("0000"), InvalidFountainDataException);
+    EXPECT_THROW(decoder.addFrame(first[0].text.substr(0, first[0].text.size() - 3)), InvalidFountainDataException);
+    EXPECT_TRUE(decoder.addFrame(first[0].text));
+    EXPECT_THROW(decoder.addFrame(other[0].text), InvalidFountainDataException);
+    EXPECT_THROW(decoder.getPayload(), InvalidFountainDataException);
+
+    // Length 0xFFFFFFFF with a block size of 1 would announce four billion blocks
+    std::vector<uint8_t> forged = {0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x12, 0x34, 0x56, 0x78, 0x00, 0x00, 0x00, 0x00, 0x41};
+    QrFountainDecoder fresh;
+    EXPECT_THROW(fresh.addFrame(toBase45(forged)), InvalidFountainDataException);
+    EXPECT_EQ(fresh.getBlockCount(), 0u);
+
+    EXPECT_THROW(QrFountainEncoder::encodeFrames("", 100, 0, 1, options), EmptyInputMessageException);
+    EXPECT_THROW(QrFountainEncoder::encodeFrames("abc", 0, 0, 1, options), InvalidFountainDataException);
+    EXPECT_THROW(QrFountainEncoder::encodeFrames(createPayload(QrFountainEncoder::MaxBlockCount + 1, 9), 1, 0, 1, options),
+                 InvalidFountainDataException);
+    EXPECT_THROW(QrFountainEncoder::encodeFrames(createPayload(10000, 8), 5000, 0, 1, options), TooLongMessageException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
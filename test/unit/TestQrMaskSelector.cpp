@@ -0,0 +1,140 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrMaskSelector.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrMaskSelector.
+ */
+class QrMaskSelectorTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Finds the best mask by scoring every mask on the whole symbol.
+     */
+    int bruteForceBestMask(const QrModuleMatrix& matrix, const QrModuleMatrix& reserved) {
+        int bestMask = 0;
+        int bestPenalty = INT_MAX;
+        for (int mask = 0; mask < QrMaskSelector::MaskCount; ++mask) {
+            QrModuleMatrix masked = matrix;
+            QrMaskSelector::applyMask(masked, reserved, mask);
+            int penalty = QrMaskSelector::getPenalty(masked);
+            if (penalty < bestPenalty) {
+                bestPenalty = penalty;
+                bestMask = mask;
+            }
+        }
+        return bestMask;
+    }
+};
+
+TEST_F(QrMaskSelectorTest, TestPenaltyOfLightSymbol) {
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(1);
+    // N1: 42 lines of 21 modules, N2: 400 blocks, N4: 0% dark
+    EXPECT_EQ(QrMaskSelector::getPenalty(matrix), 42 * 19 + 400 * 3 + 100);
+}
+
+TEST_F(QrMaskSelectorTest, TestFinderLikePattern) {
+    QrModuleMatrix matrix(11);
+    const char* pattern = "10111010000";
+    for (int col = 0; col < 11; ++col) {
+        matrix.set(0, col, pattern[col] == '1');
+    }
+    // N1: 10 light rows (9 each), 5 columns with one dark module (8 each) and 6 light columns (9 each)
+    // N2: 3 light blocks touching the first row and 90 below it
+    // N3: one finder-like pattern in the first row
+    // N4: 5 of 121 modules dark
+    EXPECT_EQ(QrMaskSelector::getPenalty(matrix), (90 + 40 + 54) + 93 * 3 + 40 + 90);
+}
+
+TEST_F(QrMaskSelectorTest, TestApplyMask) {
+    QrModuleMatrix reserved = QrModuleMatrix::fromVersion(3);
+    reserved.set(0, 0, true);
+    reserved.set(5, 7, true);
+    for (int mask = 0; mask < QrMaskSelector::MaskCount; ++mask) {
+        QrModuleMatrix matrix = QrModuleMatrix::fromVersion(3);
+        QrMaskSelector::applyMask(matrix, reserved, mask);
+        for (int row = 0; row < matrix.size(); ++row) {
+            for (int col = 0; col < matrix.size(); ++col) {
+                bool expected = !reserved.get(row, col) && QrMaskSelector::isMasked(mask, row, col);
+                ASSERT_EQ(matrix.get(row, col), expected) << "mask " << mask << " at " << row << "," << col;
+            }
+        }
+    }
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(3);
+    EXPECT_THROW(QrMaskSelector::applyMask(matrix, reserved, 8), InvalidMaskException);
+}
+
+TEST_F(QrMaskSelectorTest, TestExhaustiveSelection) {
+    QrEncodeOptions options;
+    options.measurePenaltyDelta = true;
+    for (int version = 1; version <= 40; version += 3) {
+        QrModuleMatrix matrix = generateRandomMatrix(version, version, 0.3);
+        QrModuleMatrix reserved = QrModuleMatrix::fromVersion(version);
+        QrMaskSelection selection = QrMaskSelector::selectMask(matrix, reserved, options);
+
+        int expectedMask = bruteForceBestMask(matrix, reserved);
+        QrModuleMatrix masked = matrix;
+        QrMaskSelector::applyMask(masked, reserved, expectedMask);
+        ASSERT_EQ(selection.mask, expectedMask);
+        ASSERT_EQ(selection.penalty, QrMaskSelector::getPenalty(masked));
+        ASSERT_EQ(selection.penaltyDelta, 0);
+    }
+}
+
+TEST_F(QrMaskSelectorTest, TestFastSelection) {
+    QrEncodeOptions options;
+    options.maskStrategy = QrMaskStrategy::Fast;
+    options.measurePenaltyDelta = true;
+    for (int version = 1; version <= 40; version += 3) {
+        QrModuleMatrix matrix = generateRandomMatrix(version, version * 7, 0.3);
+        QrModuleMatrix reserved = QrModuleMatrix::fromVersion(version);
+        QrMaskSelection selection = QrMaskSelector::selectMask(matrix, reserved, options);
+
+        QrModuleMatrix masked = matrix;
+        QrMaskSelector::applyMask(masked, reserved, selection.mask);
+        ASSERT_EQ(selection.penalty, QrMaskSelector::getPenalty(masked));
+        ASSERT_GE(selection.penaltyDelta, 0);
+    }
+
+    // Without the measurement the full penalty is not computed at all
+    options.measurePenaltyDelta = false;
+    QrMaskSelection selection = QrMaskSelector::selectMask(generateRandomMatrix(5, 1), QrModuleMatrix::fromVersion(5), options);
+    EXPECT_EQ(selection.penalty, -1);
+    EXPECT_EQ(selection.penaltyDelta, -1);
+}
+
+TEST_F(QrMaskSelectorTest, TestParallelSelectionIsDeterministic) {
+    QrEncodeOptions serial;
+    QrEncodeOptions parallel;
+    parallel.threadBudget = 4;
+    parallel.parallelVersionThreshold = 20;
+    for (int version = 20; version <= 40; version += 4) {
+        QrModuleMatrix matrix = generateRandomMatrix(version, version * 13, 0.4);
+        QrModuleMatrix reserved = QrModuleMatrix::fromVersion(version);
+        for (int x = 0; x < 5; ++x) {
+            QrMaskSelection expected = QrMaskSelector::selectMask(matrix, reserved, serial);
+            QrMaskSelection actual = QrMaskSelector::selectMask(matrix, reserved, parallel);
+            ASSERT_EQ(actual.mask, expected.mask);
+            ASSERT_EQ(actual.penalty, expected.penalty);
+        }
+    }
+}
+
+TEST_F(QrMaskSelectorTest, TestFixedSelection) {
+    QrEncodeOptions options;
+    options.maskStrategy = QrMaskStrategy::Fixed;
+    QrModuleMatrix matrix = generateRandomMatrix(2, 3);
+    QrModuleMatrix reserved = QrModuleMatrix::fromVersion(2);
+    for (int mask = 0; mask < QrMaskSelector::MaskCount; ++mask) {
+        options.fixedMask = mask;
+        QrMaskSelection selection = QrMaskSelector::selectMask(matrix, reserved, options);
+        EXPECT_EQ(selection.mask, mask);
+        EXPECT_EQ(selection.penalty, -1);
+    }
+    options.fixedMask = -1;
+    EXPECT_THROW(QrMaskSelector::selectMask(matrix, reserved, options), InvalidMaskException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrModeAccumulator.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrModeAccumulator. Compares incremental answers with QrModeSelector.
+ */
+class QrModeAccumulatorTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Checks that the accumulator agrees with the whole message validators.
+     * @param accumulator Accumulator holding the message.
+     */
+    void checkMatchesSelector(const QrModeAccumulator& accumulator) {
+        const std::string& input = accumulator.data();
+        ASSERT_EQ(accumulator.isNumeric(), QrModeValidator::isNumeric(input)) << "testing \"" << input << "\"";
+        ASSERT_EQ(accumulator.isAlphanumeric(), QrModeValidator::isAlphanumeric(input)) << "testing \"" << input << "\"";
+        ASSERT_EQ(accumulator.isByte(), QrModeValidator::isByte(input)) << "testing \"" << input << "\"";
+        ASSERT_EQ(accumulator.isKanji(), QrModeValidator::isKanji(input)) << "testing \"" << input << "\"";
+        if (!input.empty() && (accumulator.isByte() || accumulator.isKanji())) {
+            ASSERT_EQ(accumulator.getQrMode(), QrModeSelector::getQrMode(input));
+            ASSERT_EQ(accumulator.getQrVersion(QrErrorCorrectionLevel::MEDIUM),
+                      QrVersionSelector::getQrVersion(input, QrErrorCorrectionLevel::MEDIUM, QrModeSelector::getQrMode(input)));
+        }
+    }
+
+    /**
+     * @brief Feeds the input in random sized chunks, checking the state after each chunk.
+     * @param input Message to feed.
+     */
+    void checkChunked(const std::string& input) {
+        std::mt19937 eng(static_cast<unsigned int>(input.size()));
+        std::uniform_int_distribution<> distr(1, 5);
+
+        QrModeAccumulator accumulator;
+        size_t position = 0;
+        while (position < input.size()) {
+            size_t chunk = std::min(static_cast<size_t>(distr(eng)), input.size() - position);
+            accumulator.append(input.data() + position, chunk);
+            position += chunk;
+            checkMatchesSelector(accumulator);
+        }
+        ASSERT_EQ(accumulator.data(), input);
+    }
+};
+
+TEST_F(QrModeAccumulatorTest, TestEmpty) {
+    QrModeAccumulator accumulator;
+    EXPECT_TRUE(accumulator.empty());
+    EXPECT_THROW(accumulator.getQrMode(), EmptyInputMessageException);
+    EXPECT_THROW(accumulator.getQrVersion(QrErrorCorrectionLevel::LOW), EmptyInputMessageException);
+}
+
+TEST_F(QrModeAccumulatorTest, TestFixedModes) {
+    QrModeAccumulator accumulator;
+    accumulator.append("12345");
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::NumericMode);
+    accumulator.append("HELLO");
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::AlphanumericMode);
+    accumulator.append("world");
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::ByteMode);
+    accumulator.pop(5);
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::AlphanumericMode);
+    accumulator.truncate(3);
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::NumericMode);
+    EXPECT_EQ(accumulator.data(), "123");
+    accumulator.pop(10);
+    EXPECT_TRUE(accumulator.empty());
+}
+
+TEST_F(QrModeAccumulatorTest, TestSplitSequences) {
+    QrModeAccumulator accumulator;
+
+    // UTF-8 character split across chunks
+    accumulator.append("a\xF0\x9F");
+    EXPECT_FALSE(accumulator.isByte());
+    accumulator.append("\x98\x81");
+    EXPECT_TRUE(accumulator.isByte());
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::ByteMode);
+
+    // Shift JIS character split across chunks
+    accumulator.clear();
+    accumulator.append("\x81");
+    EXPECT_THROW(accumulator.getQrMode(), InvalidInputMessageException);
+    accumulator.append("\x40");
+    EXPECT_EQ(accumulator.getQrMode(), QrMode::KanjiMode);
+    accumulator.pop();
+    EXPECT_FALSE(accumulator.isKanji());
+}
+
+TEST_F(QrModeAccumulatorTest, TestVersionGrowsWithInput) {
+    QrModeAccumulator accumulator;
+    accumulator.append(std::string(41, '0'));
+    EXPECT_EQ(accumulator.getQrVersion(QrErrorCorrectionLevel::LOW), 1);
+    accumulator.append("0");
+    EXPECT_EQ(accumulator.getQrVersion(QrErrorCorrectionLevel::LOW), 2);
+    accumulator.pop();
+    EXPECT_EQ(accumulator.getQrVersion(QrErrorCorrectionLevel::LOW), 1);
+
+    accumulator.append(std::string(7089 - 41 + 1, '0'));
+    EXPECT_THROW(accumulator.getQrVersion(QrErrorCorrectionLevel::LOW), TooLongMessageException);
+}
+
+TEST_F(QrModeAccumulatorTest, TestRandomChunked) {
+    for (int x = 0; x < 200; ++x) {
+        checkChunked(generateRandomNumericString(50));
+        checkChunked(generateRandomAlphanumericString(50));
+        checkChunked(generateRandomByteString(50));
+        checkChunked(generateRandomKanjiString(25));
+    }
+}
+
+TEST_F(QrModeAccumulatorTest, TestRandomEditing) {
+    std::mt19937 eng(1234);
+    std::uniform_int_distribution<> byteDistr(0, 255);
+    std::uniform_int_distribution<> actionDistr(0, 3);
+
+    QrModeAccumulator accumulator;
+    for (int x = 0; x < 20000; ++x) {
+        if (actionDistr(eng) == 0) {
+            accumulator.pop();
+        } else {
+            char c = static_cast<char>(byteDistr(eng));
+            accumulator.append(&c, 1);
+        }
+        checkMatchesSelector(accumulator);
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+#include "../../include/QrParallel.hpp"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(QrParallelTest, TestThreadCountFollowsVersionThreshold) {
+    QrEncodeOptions options;
+    EXPECT_EQ(QrParallel::getThreadCount(40, options), 1);
+
+    options.threadBudget = 4;
+    EXPECT_EQ(QrParallel::getThreadCount(29, options), 1);
+    EXPECT_EQ(QrParallel::getThreadCount(30, options), 4);
+    EXPECT_EQ(QrParallel::getThreadCount(40, options), 4);
+
+    options.parallelVersionThreshold = 1;
+    EXPECT_EQ(QrParallel::getThreadCount(1, options), 4);
+
+    // Options without their own threshold follow the tuned one
+    options.parallelVersionThreshold = 0;
+    QrParallel::setVersionThreshold(35);
+    EXPECT_EQ(QrParallel::getThreadCount(34, options), 1);
+    EXPECT_EQ(QrParallel::getThreadCount(35, options), 4);
+    QrParallel::setVersionThreshold(30);
+}
+
+TEST(QrParallelTest, TestEveryTaskRunsOnce) {
+    for (int threads = 1; threads <= 8; ++threads) {
+        std::vector<int> runs(1000, 0);
+        QrParallel::forEach(runs.size(), threads, [&](size_t i) {
+            runs[i] += 1;
+        });
+        ASSERT_EQ(runs, std::vector<int>(1000, 1)) << "with " << threads << " threads";
+    }
+}
+
+TEST(QrParallelTest, TestExceptionOfLowestIndexIsRethrown) {
+    std::vector<int> runs(100, 0);
+    try {
+        QrParallel::forEach(runs.size(), 4, [&](size_t i) {
+            runs[i] = 1;
+            if (i % 10 == 3) {
+                throw std::runtime_error(std::to_string(i));
+            }
+        });
+        FAIL() << "expected an exception";
+    } catch (const std::runtime_error& e) {
+        EXPECT_EQ(std::string(e.what()), "3");
+    }
+    EXPECT_EQ(runs, std::vector<int>(100, 1));
+}
+
+TEST(QrParallelTest, TestThreadsAreReused) {
+    std::mutex idsMutex;
+    std::set<std::thread::id> ids;
+    for (int call = 0; call < 50; ++call) {
+        QrParallel::forEach(16, 3, [&](size_t) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            std::lock_guard<std::mutex> lock(idsMutex);
+            ids.insert(std::this_thread::get_id());
+        });
+    }
+    // The calling thread and the pool threads, which earlier tests grew to at most seven
+    EXPECT_LE(ids.size(), 8u);
+    EXPECT_EQ(ids.count(std::this_thread::get_id()), 1u);
+}
+
+TEST(QrParallelTest, TestConcurrentAndNestedCalls) {
+    std::vector<std::vector<int>> runs(4, std::vector<int>(64, 0));
+    std::vector<std::thread> callers;
+    for (size_t caller = 0; caller < runs.size(); ++caller) {
+        callers.push_back(std::thread([&runs, caller]() {
+            for (int repeat = 0; repeat < 20; ++repeat) {
+                QrParallel::forEach(8, 3, [&runs, caller](size_t outer) {
+                    QrParallel::forEach(8, 2, [&runs, caller, outer](size_t inner) {
+                        runs[caller][outer * 8 + inner] += 1;
+                    });
+                });
+            }
+        }));
+    }
+    for (std::thread& caller : callers) {
+        caller.join();
+    }
+    for (size_t caller = 0; caller < runs.size(); ++caller) {
+        EXPECT_EQ(runs[caller], std::vector<int>(64, 20)) << "caller " << caller;
+    }
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
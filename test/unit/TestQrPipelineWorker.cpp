@@ -0,0 +1,104 @@
+#include "../../bench/utils/QrPipelineWorker.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+
+/**
+ * @brief Test fixture for the counters reported by BenchQrScalability. Builds the shared placement tables
+ * first, so only the work of the symbols is counted.
+ */
+class QrPipelineWorkerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        for (int version = 1; version <= 40; ++version) {
+            QrCodewordPlacement::getTable(version);
+        }
+    }
+
+    /**
+     * @brief Runs the payloads on the given number of threads and sums the counters of all threads.
+     */
+    WorkerStats runWorkers(const std::vector<std::string>& payloads, int threadCount) {
+        QrEncodeOptions options;
+        std::atomic<size_t> nextIndex(0);
+        std::vector<WorkerStats> stats(threadCount);
+        std::vector<std::thread> threads;
+        for (int t = 1; t < threadCount; ++t) {
+            threads.push_back(std::thread(runWorker, std::cref(payloads), std::cref(options), 2,
+                                          std::ref(nextIndex), std::ref(stats[t])));
+        }
+        runWorker(payloads, options, 2, nextIndex, stats[0]);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        WorkerStats total;
+        for (const WorkerStats& worker : stats) {
+            total.latencies.insert(total.latencies.end(), worker.latencies.begin(), worker.latencies.end());
+            total.allocations += worker.allocations;
+            total.claimRetries += worker.claimRetries;
+            total.checksum += worker.checksum;
+        }
+        return total;
+    }
+};
+
+TEST_F(QrPipelineWorkerTest, TestAllocationsAreCountedPerThread) {
+    // Volatile pointers keep the compiler from eliding the allocations
+    uint64_t before = threadAllocationCount;
+    int* volatile value = new int(1);
+    char* volatile buffer = new char[16];
+    EXPECT_EQ(threadAllocationCount - before, 2u);
+    delete value;
+    delete[] buffer;
+
+    // Every thread starts its own counter
+    uint64_t otherStart = 1;
+    uint64_t otherCount = 0;
+    std::thread other([&]() {
+        otherStart = threadAllocationCount;
+        int* volatile value = new int(5);
+        delete value;
+        otherCount = threadAllocationCount - otherStart;
+    });
+    other.join();
+    EXPECT_EQ(otherStart, 0u);
+    EXPECT_EQ(otherCount, 1u);
+}
+
+TEST_F(QrPipelineWorkerTest, TestAllocationsPerSymbol) {
+    std::vector<std::string> payloads = generatePayloadMix("mixed", 200, 39);
+
+    // Every symbol makes the same allocations wherever it runs, so the totals match the sum over the symbols
+    uint64_t expected = 0;
+    QrEncodeOptions options;
+    for (const std::string& payload : payloads) {
+        uint64_t before = threadAllocationCount;
+        processSymbol(payload, options, 2);
+        uint64_t allocations = threadAllocationCount - before;
+        // At least the codewords and the copy of the reserved matrix
+        ASSERT_GE(allocations, 2u);
+        expected += allocations;
+    }
+
+    for (int threadCount = 1; threadCount <= 4; ++threadCount) {
+        WorkerStats stats = runWorkers(payloads, threadCount);
+        EXPECT_EQ(stats.allocations, expected) << "with " << threadCount << " threads";
+        EXPECT_EQ(stats.latencies.size(), payloads.size()) << "with " << threadCount << " threads";
+    }
+}
+
+TEST_F(QrPipelineWorkerTest, TestSingleThreadNeverRetriesClaims) {
+    std::vector<std::string> payloads = generatePayloadMix("ids", 500, 39);
+    WorkerStats single = runWorkers(payloads, 1);
+    EXPECT_EQ(single.claimRetries, 0u);
+
+    // Every symbol is claimed once however the claims interleave
+    WorkerStats shared = runWorkers(payloads, 4);
+    EXPECT_EQ(shared.latencies.size(), payloads.size());
+    EXPECT_EQ(shared.checksum, single.checksum);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
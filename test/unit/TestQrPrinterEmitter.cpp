@@ -0,0 +1,130 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrPrinterEmitter.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrPrinterEmitter. Decodes the printer commands back into dot rows.
+ */
+class QrPrinterEmitterTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Checks whether a dot is black in the expected printed image.
+     */
+    bool expectedDot(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone, int x, int y) {
+        int row = y / dotsPerModule - quietZone;
+        int col = x / dotsPerModule - quietZone;
+        if (row < 0 || col < 0 || row >= matrix.size() || col >= matrix.size()) {
+            return false;
+        }
+        return matrix.get(row, col);
+    }
+
+    /**
+     * @brief Expands the ZPL compressed ^GFA data into hex rows.
+     */
+    std::vector<std::string> decodeZpl(const std::string& command, int& bytesPerRow) {
+        size_t first = command.find(',');
+        size_t second = command.find(',', first + 1);
+        size_t third = command.find(',', second + 1);
+        size_t fourth = command.find(',', third + 1);
+        bytesPerRow = std::stoi(command.substr(third + 1, fourth - third - 1));
+
+        std::vector<std::string> rows;
+        std::string row;
+        int count = 0;
+        for (size_t i = fourth + 1; i < command.size(); ++i) {
+            char c = command[i];
+            if (c >= 'G' && c <= 'Y') {
+                count += c - 'G' + 1;
+            } else if (c >= 'g' && c <= 'z') {
+                count += (c - 'g' + 1) * 20;
+            } else if (c == ',' || c == '!') {
+                row.append(bytesPerRow * 2 - row.size(), c == ',' ? '0' : 'F');
+            } else if (c == ':') {
+                row = rows.back();
+            } else {
+                row.append(count == 0 ? 1 : count, c);
+                count = 0;
+            }
+            if (row.size() == static_cast<size_t>(bytesPerRow * 2)) {
+                rows.push_back(row);
+                row.clear();
+            }
+        }
+        return rows;
+    }
+};
+
+TEST_F(QrPrinterEmitterTest, TestZplRoundTrip) {
+    for (int version = 1; version <= 40; version += 13) {
+        for (int dotsPerModule = 1; dotsPerModule <= 5; dotsPerModule += 2) {
+            QrModuleMatrix matrix = generateRandomMatrix(version, version * 10 + dotsPerModule);
+            std::ostringstream out;
+            QrPrinterEmitter::writeZpl(matrix, dotsPerModule, 4, out);
+
+            int bytesPerRow = 0;
+            std::vector<std::string> rows = decodeZpl(out.str(), bytesPerRow);
+            int dots = (matrix.size() + 8) * dotsPerModule;
+            ASSERT_EQ(bytesPerRow, (dots + 7) / 8);
+            ASSERT_EQ(rows.size(), static_cast<size_t>(dots));
+            for (int y = 0; y < dots; ++y) {
+                for (int x = 0; x < dots; ++x) {
+                    int nibble = std::stoi(rows[y].substr(x / 4, 1), nullptr, 16);
+                    bool dot = (nibble >> (3 - x % 4)) & 1;
+                    ASSERT_EQ(dot, expectedDot(matrix, dotsPerModule, 4, x, y)) << "at " << x << "," << y;
+                }
+            }
+        }
+    }
+}
+
+TEST_F(QrPrinterEmitterTest, TestZplCompression) {
+    QrModuleMatrix matrix(1);
+    matrix.set(0, 0, true);
+    std::ostringstream out;
+    QrPrinterEmitter::writeZpl(matrix, 8, 1, out);
+
+    // 24 dots wide: a light row, then a row with a black middle byte, repeated, then light again
+    EXPECT_EQ(out.str(), "^GFA,72,72,3,,:::::::H0HF,:::::::,:::::::");
+}
+
+TEST_F(QrPrinterEmitterTest, TestEscPosRaster) {
+    QrModuleMatrix matrix = generateRandomMatrix(40, 7);
+    int dotsPerModule = 2;
+    std::ostringstream out;
+    QrPrinterEmitter::writeEscPos(matrix, dotsPerModule, 4, out);
+    std::string data = out.str();
+
+    int dots = (matrix.size() + 8) * dotsPerModule;
+    int bytesPerRow = (dots + 7) / 8;
+    size_t position = 0;
+    int y = 0;
+    while (position < data.size()) {
+        ASSERT_EQ(data.substr(position, 4), std::string("\x1Dv0\0", 4));
+        ASSERT_EQ(static_cast<unsigned char>(data[position + 4]) + 256 * static_cast<unsigned char>(data[position + 5]), bytesPerRow);
+        int bandRows = static_cast<unsigned char>(data[position + 6]) + 256 * static_cast<unsigned char>(data[position + 7]);
+        ASSERT_LE(bandRows, QrPrinterEmitter::EscPosMaxBandRows);
+        position += 8;
+        for (int bandRow = 0; bandRow < bandRows; ++bandRow, ++y) {
+            for (int x = 0; x < dots; ++x) {
+                bool dot = (static_cast<unsigned char>(data[position + x / 8]) >> (7 - x % 8)) & 1;
+                ASSERT_EQ(dot, expectedDot(matrix, dotsPerModule, 4, x, y)) << "at " << x << "," << y;
+            }
+            position += bytesPerRow;
+        }
+    }
+    EXPECT_EQ(y, dots);
+}
+
+TEST_F(QrPrinterEmitterTest, TestInvalidParameters) {
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(1);
+    std::ostringstream out;
+    EXPECT_THROW(QrPrinterEmitter::writeZpl(matrix, 0, 4, out), InvalidPrinterParametersException);
+    EXPECT_THROW(QrPrinterEmitter::writeEscPos(matrix, 1, -1, out), InvalidPrinterParametersException);
+    EXPECT_THROW(QrModuleMatrix::fromVersion(41), InvalidVersionException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
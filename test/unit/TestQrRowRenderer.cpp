@@ -0,0 +1,79 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrRowRenderer.hpp"
+#include "../../include/QrVersionSelector.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrRowRenderer.
+ */
+class QrRowRendererTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Checks every dot of every row against the module it belongs to.
+     */
+    void checkRendering(const QrModuleMatrix& matrix, int dotsPerModule, int quietZone) {
+        QrRowRenderer renderer(matrix, dotsPerModule, quietZone);
+        int dots = (matrix.size() + 2 * quietZone) * dotsPerModule;
+        ASSERT_EQ(renderer.size(), dots);
+        ASSERT_EQ(renderer.bytesPerRow(), (dots + 7) / 8);
+
+        int rows = 0;
+        while (const unsigned char* row = renderer.nextRow()) {
+            ASSERT_EQ(renderer.rowIndex(), rows);
+            int moduleRow = rows / dotsPerModule - quietZone;
+            for (int x = 0; x < renderer.bytesPerRow() * 8; ++x) {
+                int moduleCol = x / dotsPerModule - quietZone;
+                bool expected = x < dots && moduleRow >= 0 && moduleRow < matrix.size() &&
+                                moduleCol >= 0 && moduleCol < matrix.size() && matrix.get(moduleRow, moduleCol);
+                ASSERT_EQ((row[x / 8] >> (7 - x % 8)) & 1, expected ? 1 : 0) << "dot " << rows << "," << x;
+            }
+            ++rows;
+        }
+        EXPECT_EQ(rows, dots);
+        EXPECT_EQ(renderer.nextRow(), nullptr);
+    }
+};
+
+TEST_F(QrRowRendererTest, TestRowsMatchModules) {
+    checkRendering(generateRandomMatrix(1, 1), 1, 0);
+    checkRendering(generateRandomMatrix(2, 2), 3, 4);
+    checkRendering(generateRandomMatrix(7, 3), 8, 2);
+    checkRendering(generateRandomMatrix(3, 4), 13, 1);
+    checkRendering(generateRandomMatrix(40, 5), 2, 4);
+}
+
+TEST_F(QrRowRendererTest, TestRepeatedRows) {
+    QrModuleMatrix matrix = generateRandomMatrix(1, 6);
+    QrRowRenderer renderer(matrix, 3, 1);
+    EXPECT_EQ(renderer.rowIndex(), -1);
+    // Every module row, including the quiet ones, covers three dot rows
+    while (renderer.nextRow()) {
+        EXPECT_EQ(renderer.repeatsPreviousRow(), renderer.rowIndex() % 3 != 0) << "row " << renderer.rowIndex();
+    }
+
+    renderer.reset();
+    const unsigned char* first = renderer.nextRow();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(renderer.rowIndex(), 0);
+    EXPECT_FALSE(renderer.repeatsPreviousRow());
+}
+
+TEST_F(QrRowRendererTest, TestDotSizeFromVersion) {
+    int version = QrVersionSelector::getQrVersion(std::string(500, 'A'), QrErrorCorrectionLevel::MEDIUM, QrMode::AlphanumericMode);
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(version);
+    QrRowRenderer renderer(matrix, 25, 4);
+    EXPECT_EQ(QrRowRenderer::getDotSize(version, 25, 4), renderer.size());
+    EXPECT_EQ(QrRowRenderer::getDotSize(40, 50, 4), (177 + 8) * 50);
+    EXPECT_THROW(QrRowRenderer::getDotSize(41, 1, 0), InvalidVersionException);
+}
+
+TEST_F(QrRowRendererTest, TestInvalidParameters) {
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(1);
+    EXPECT_THROW(QrRowRenderer(matrix, 0, 4), InvalidRenderParametersException);
+    EXPECT_THROW(QrRowRenderer(matrix, 1, -1), InvalidRenderParametersException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
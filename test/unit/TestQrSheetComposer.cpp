@@ -0,0 +1,165 @@
+#include "../utils/QrTestUtils.hpp"
+#include "../../include/QrSheetComposer.hpp"
+#include <gtest/gtest.h>
+
+/**
+ * @brief Test fixture for QrSheetComposer.
+ */
+class QrSheetComposerTest : public ::testing::Test {
+protected:
+    /**
+     * @brief Builds symbols of mixed versions with random dark modules.
+     */
+    std::vector<QrModuleMatrix> createSymbols(size_t count) {
+        std::vector<QrModuleMatrix> symbols;
+        for (size_t i = 0; i < count; ++i) {
+            symbols.push_back(generateRandomMatrix(1 + static_cast<int>(i % 3), static_cast<unsigned int>(count * 100 + i)));
+        }
+        return symbols;
+    }
+
+    /**
+     * @brief Counts the runs of dark modules over all rows of the symbols.
+     */
+    size_t countDarkRuns(const std::vector<QrModuleMatrix>& symbols) {
+        size_t runs = 0;
+        for (const QrModuleMatrix& symbol : symbols) {
+            for (int row = 0; row < symbol.size(); ++row) {
+                for (int col = 0; col < symbol.size(); ++col) {
+                    if (symbol.get(row, col) && (col == 0 || !symbol.get(row, col - 1))) {
+                        ++runs;
+                    }
+                }
+            }
+        }
+        return runs;
+    }
+
+    /**
+     * @brief Counts the occurrences of a string.
+     */
+    size_t countOccurrences(const std::string& text, const std::string& pattern) {
+        size_t count = 0;
+        for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1)) {
+            ++count;
+        }
+        return count;
+    }
+};
+
+TEST_F(QrSheetComposerTest, TestCellSizeFollowsVersion) {
+    std::vector<std::string> payloads;
+    payloads.push_back("12345");
+    payloads.push_back("");
+    EXPECT_EQ(QrSheetComposer::getCellModules(payloads, QrErrorCorrectionLevel::LOW, 4), 21 + 8);
+    payloads.push_back(std::string(100, 'A'));
+    EXPECT_EQ(QrSheetComposer::getCellModules(payloads, QrErrorCorrectionLevel::LOW, 4), 33 + 8);
+    EXPECT_EQ(QrSheetComposer::getCellModules(std::vector<std::string>(1, ""), QrErrorCorrectionLevel::LOW, 4), 0);
+}
+
+TEST_F(QrSheetComposerTest, TestPbmPlacement) {
+    std::vector<QrModuleMatrix> symbols = createSymbols(23);
+    QrSheetLayout layout;
+    layout.columns = 5;
+    layout.dotsPerModule = 3;
+    layout.margin = 13;
+    layout.gutter = 5;
+
+    std::ostringstream serial;
+    QrSheetComposer::writePbm(symbols, layout, 1, serial);
+    std::ostringstream parallel;
+    QrSheetComposer::writePbm(symbols, layout, 4, parallel);
+    ASSERT_EQ(serial.str(), parallel.str());
+
+    std::istringstream in(serial.str());
+    std::string magic;
+    int width = 0;
+    int height = 0;
+    in >> magic >> width >> height;
+    in.get();
+    std::string pixels((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    int cellDots = (29 + 8) * 3;
+    ASSERT_EQ(magic, "P4");
+    ASSERT_EQ(width, 2 * 13 + 5 * cellDots + 4 * 5);
+    ASSERT_EQ(height, 2 * 13 + 5 * cellDots + 4 * 5);
+    ASSERT_EQ(pixels.size(), static_cast<size_t>((width + 7) / 8 * height));
+
+    for (size_t index = 0; index < symbols.size(); ++index) {
+        const QrModuleMatrix& symbol = symbols[index];
+        int offset = (29 + 8 - symbol.size()) / 2 * 3;
+        int x = 13 + static_cast<int>(index % 5) * (cellDots + 5) + offset;
+        int y = 13 + static_cast<int>(index / 5) * (cellDots + 5) + offset;
+        for (int row = 0; row < symbol.size(); ++row) {
+            for (int col = 0; col < symbol.size(); ++col) {
+                int dotX = x + col * 3 + 1;
+                int dotY = y + row * 3 + 2;
+                bool dot = (static_cast<unsigned char>(pixels[dotY * ((width + 7) / 8) + dotX / 8]) >> (7 - dotX % 8)) & 1;
+                ASSERT_EQ(dot, symbol.get(row, col)) << "symbol " << index << " at " << row << "," << col;
+            }
+        }
+    }
+}
+
+TEST_F(QrSheetComposerTest, TestFixedCellSize) {
+    std::vector<std::string> payloads;
+    payloads.push_back("12345");
+    payloads.push_back(std::string(100, 'A'));
+    QrSheetLayout layout;
+    layout.columns = 2;
+    layout.dotsPerModule = 2;
+    layout.cellModules = QrSheetComposer::getCellModules(payloads, QrErrorCorrectionLevel::LOW, layout.quietZone);
+
+    // Only the small symbol is on this sheet, but the cell keeps the size of the batch
+    std::vector<QrModuleMatrix> symbols(1, generateRandomMatrix(1, 41));
+    std::ostringstream out;
+    QrSheetComposer::writePbm(symbols, layout, 1, out);
+    std::istringstream in(out.str());
+    std::string magic;
+    int width = 0;
+    in >> magic >> width;
+    EXPECT_EQ(width, (33 + 8) * 2);
+
+    layout.cellModules = 21 + 7;
+    EXPECT_THROW(QrSheetComposer::writePbm(symbols, layout, 1, out), InvalidSheetLayoutException);
+    layout.cellModules = -1;
+    EXPECT_THROW(QrSheetComposer::writePdf(symbols, layout, 1, out), InvalidSheetLayoutException);
+}
+
+TEST_F(QrSheetComposerTest, TestPdfStructure) {
+    std::vector<QrModuleMatrix> symbols = createSymbols(12);
+    symbols.push_back(QrModuleMatrix::fromVersion(1));
+    QrSheetLayout layout;
+    layout.columns = 4;
+
+    std::ostringstream out;
+    QrSheetComposer::writePdf(symbols, layout, 3, out);
+    std::string pdf = out.str();
+
+    EXPECT_EQ(pdf.substr(0, 9), "%PDF-1.4\n");
+    EXPECT_EQ(pdf.substr(pdf.size() - 6), "%%EOF\n");
+    EXPECT_EQ(countOccurrences(pdf, " re\n"), countDarkRuns(symbols));
+    EXPECT_EQ(countOccurrences(pdf, "\nf\n"), 12u);
+
+    // Every cross reference entry points to its object
+    size_t xref = std::stoul(pdf.substr(pdf.rfind("startxref\n") + 10));
+    ASSERT_EQ(pdf.substr(xref, 5), "xref\n");
+    for (int object = 1; object <= 4; ++object) {
+        size_t offset = std::stoul(pdf.substr(xref + 5 + 4 + 20 * object, 10));
+        EXPECT_EQ(pdf.substr(offset, 8), std::to_string(object) + " 0 obj\n");
+    }
+}
+
+TEST_F(QrSheetComposerTest, TestInvalidLayout) {
+    std::vector<QrModuleMatrix> symbols = createSymbols(2);
+    QrSheetLayout layout;
+    layout.columns = 0;
+    std::ostringstream out;
+    EXPECT_THROW(QrSheetComposer::writePbm(symbols, layout, 1, out), InvalidSheetLayoutException);
+    EXPECT_THROW(QrSheetComposer::writePdf(std::vector<QrModuleMatrix>(), QrSheetLayout(), 1, out), InvalidSheetLayoutException);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
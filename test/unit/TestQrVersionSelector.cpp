@@ -1,5 +1,6 @@
 #include "../utils/QrTestUtils.hpp"
 #include "../../include/QrModeSelector.hpp"
+#include "../../include/QrModuleMatrix.hpp"
 #include "../../include/QrVersionSelector.hpp"
 #include <gtest/gtest.h>
 
@@ -292,6 +293,13 @@ TEST_F(QrVersionSelectorTest, TestMessageMaxInputLength) {
 
 }
 
+TEST_F(QrVersionSelectorTest, TestDataCapacityRejectsInvalidVersions) {
+    EXPECT_EQ(QrVersionSelector::getDataCapacity(1, QrErrorCorrectionLevel::LOW, QrMode::NumericMode), 41);
+    EXPECT_EQ(QrVersionSelector::getDataCapacity(40, QrErrorCorrectionLevel::LOW, QrMode::NumericMode), 7089);
+    EXPECT_THROW(QrVersionSelector::getDataCapacity(0, QrErrorCorrectionLevel::LOW, QrMode::NumericMode), InvalidVersionException);
+    EXPECT_THROW(QrVersionSelector::getDataCapacity(41, QrErrorCorrectionLevel::HIGH, QrMode::KanjiMode), InvalidVersionException);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
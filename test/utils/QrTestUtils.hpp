@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../../include/QrModuleMatrix.hpp"
 #include <iostream>
 #include <string>
 #include <random>
@@ -124,3 +125,25 @@ std::string generateRandomKanjiString(size_t length) {
     }
     return input;
 }
+
+/**
+ * Generates a symbol matrix of the specified version with random dark modules.
+ *
+ * The same version and seed always give the same matrix.
+ *
+ * @param version Version of the symbol (1-40).
+ * @param seed Seed of the random pattern.
+ * @param darkRatio Probability of each module being dark.
+ * @return Matrix with every module set at random.
+ */
+QrModuleMatrix generateRandomMatrix(int version, unsigned int seed, double darkRatio = 0.5) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution dark(darkRatio);
+    QrModuleMatrix matrix = QrModuleMatrix::fromVersion(version);
+    for (int row = 0; row < matrix.size(); ++row) {
+        for (int col = 0; col < matrix.size(); ++col) {
+            matrix.set(row, col, dark(generator));
+        }
+    }
+    return matrix;
+}